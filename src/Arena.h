@@ -0,0 +1,108 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+const std::size_t ARENA_ALIGNMENT = 64; // Every block starts on its own cache line
+// Gap separate() leaves between regions written by different threads: two cache lines, since
+// the adjacent-line prefetcher pulls lines in pairs and would otherwise bounce them between cores
+const std::size_t ARENA_SEPARATION = 2 * ARENA_ALIGNMENT;
+
+// Bytes a block of n objects takes in an arena, rounded up to whole cache lines
+template <typename T>
+std::size_t arena_block_bytes(std::size_t n) {
+    return (n * sizeof(T) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+// Stands in for an Arena to measure a layout: run the same allocate() calls against it first,
+// then size the Arena with bytes()
+class ArenaSizer {
+private:
+    std::size_t total = 0;
+
+public:
+    template <typename T>
+    T* allocate(std::size_t n) {
+        total += arena_block_bytes<T>(n);
+        return nullptr;
+    }
+
+    template <typename T>
+    T* create(std::size_t n, const T&) {
+        return allocate<T>(n);
+    }
+
+    void separate() { total += ARENA_SEPARATION; }
+
+    std::size_t bytes() const { return total; }
+};
+
+// A single up-front allocation handed out as zeroed, cache-line aligned blocks.
+// Blocks are never freed individually: everything lives until the arena is destroyed, so a
+// session's buffers can be carved out once at startup and nothing allocates afterwards.
+// create() constructs objects in a block; their destructors are the caller's to run (destroy()).
+class Arena {
+private:
+    void* storage; // As returned by malloc
+    char* base; // storage rounded up to ARENA_ALIGNMENT
+    std::size_t capacity;
+    std::size_t used;
+
+public:
+    explicit Arena(std::size_t bytes)
+        : storage(std::malloc(bytes + ARENA_ALIGNMENT)), base(nullptr), capacity(storage ? bytes : 0), used(0) {
+        if (storage) {
+            std::uintptr_t address = (std::uintptr_t)storage;
+            base = (char*)((address + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT);
+            std::memset(base, 0, capacity);
+        }
+    }
+    ~Arena() { std::free(storage); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Storage for n objects of a trivial type, or nullptr once the arena is exhausted
+    template <typename T>
+    T* allocate(std::size_t n) {
+        std::size_t bytes = arena_block_bytes<T>(n);
+        if (bytes > capacity - used) {
+            return nullptr;
+        }
+        T* block = (T*)(base + used);
+        used += bytes;
+        return block;
+    }
+
+    // n objects copy-constructed from prototype, or nullptr once the arena is exhausted
+    template <typename T>
+    T* create(std::size_t n, const T& prototype) {
+        T* block = allocate<T>(n);
+        for (std::size_t i = 0; block && i < n; ++i) {
+            new (block + i) T(prototype);
+        }
+        return block;
+    }
+
+    // Run the destructors of n objects made by create()
+    template <typename T>
+    static void destroy(T* block, std::size_t n) {
+        for (std::size_t i = 0; block && i < n; ++i) {
+            block[i].~T();
+        }
+    }
+
+    // Leave a gap so the blocks before and after never share (or prefetch) a cache line: call it
+    // between the regions of different threads
+    void separate() { used += used + ARENA_SEPARATION <= capacity ? ARENA_SEPARATION : capacity - used; }
+
+    bool is_valid() const { return base != nullptr; }
+    std::size_t size() const { return capacity; }
+    std::size_t bytes_used() const { return used; }
+};
+
+#endif // ARENA_H
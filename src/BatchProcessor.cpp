@@ -0,0 +1,383 @@
+#include "BatchProcessor.h"
+#include "Arena.h"
+#include "ChainBank.h"
+#include "ChannelScheduler.h"
+#include "Logger.h"
+#include "Recording.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+const std::size_t BATCH_BLOCK_SIZE = 65536; // Samples read, filtered and written per pass
+const std::size_t BATCH_IO_BUFFER = 1 << 20; // stdio buffer size for input and output files
+const std::size_t TEXT_LINE_SIZE = 65536; // Longest text line accepted (a frame of every channel)
+
+typedef std::chrono::steady_clock batch_clock;
+
+static bool has_extension(const char* path, const char* extension) {
+    std::size_t path_length = std::strlen(path);
+    std::size_t extension_length = std::strlen(extension);
+    return path_length >= extension_length && std::strcmp(path + path_length - extension_length, extension) == 0;
+}
+
+// Where frames come from: a raw/text file through stdio, or a mapped recording (the raw stream
+// of each source channel)
+struct BatchInput {
+    FILE* file = nullptr;
+    bool binary = false;
+    RecordingReader recording;
+    std::uint64_t position = 0; // Next recording frame
+};
+
+// Where results go: a raw/text file through stdio, or a recording of every stage
+struct BatchOutput {
+    FILE* file = nullptr;
+    bool binary = false;
+    RecordingWriter recording;
+    std::vector<float> frames; // Interleaved scratch for float32 pairs
+};
+
+// Return up to n input frames of channels samples each, pointing straight into the mapping
+// when the recording allows it and reading into scratch otherwise; returns 0 at the end of the
+// input
+static std::size_t read_samples(BatchInput& input, std::size_t channels, float* scratch, std::size_t n,
+                                const float*& samples) {
+    samples = scratch;
+    if (input.recording.is_open()) {
+        std::size_t run;
+        const float* span = channels == 1 ? input.recording.channel_span(input.position, STREAM_RAW, run) : nullptr;
+        std::size_t count;
+        if (span) {
+            samples = span;
+            count = std::min(run, n);
+        } else if (channels == 1) {
+            count = input.recording.read_channel(STREAM_RAW, input.position, scratch, n);
+        } else {
+            // Source channel c's raw stream is recording channel c * STREAM_COUNT
+            count = (std::size_t)std::min<std::uint64_t>(n, input.recording.frames() - input.position);
+            for (std::size_t i = 0; i < count; ++i) {
+                for (std::size_t c = 0; c < channels; ++c) {
+                    scratch[i * channels + c] =
+                        input.recording.sample(input.position + i, (std::uint32_t)(c * STREAM_COUNT + STREAM_RAW));
+                }
+            }
+        }
+        input.position += count;
+        return count;
+    }
+
+    if (input.binary) {
+        return std::fread(scratch, channels * sizeof(float), n, input.file);
+    }
+
+    // A frame per line, its channels separated by commas; lines without channels numbers (such
+    // as headers) are skipped
+    char line[TEXT_LINE_SIZE];
+    std::size_t count = 0;
+    while (count < n && std::fgets(line, sizeof(line), input.file)) {
+        float* frame = scratch + count * channels;
+        const char* text = line;
+        std::size_t c = 0;
+        for (; c < channels; ++c) {
+            char* end;
+            frame[c] = std::strtof(text, &end);
+            if (end == text) {
+                break;
+            }
+            text = end;
+            while (*text == ',' || *text == ' ' || *text == '\t') {
+                ++text;
+            }
+        }
+        count += c == channels;
+    }
+    return count;
+}
+
+// Filter chain outputs for one block: n frames of channels * STREAM_COUNT taps, each channel's
+// in RecordedStream order
+static bool write_samples(BatchOutput& output, std::size_t channels, const float* taps, std::size_t n) {
+    if (output.recording.is_open()) {
+        return output.recording.write(taps, n) == n;
+    }
+
+    const std::size_t streams = n * channels;
+    if (output.binary) {
+        for (std::size_t i = 0; i < streams; ++i) {
+            output.frames[2 * i] = taps[i * STREAM_COUNT + STREAM_BANDPASSED];
+            output.frames[2 * i + 1] = taps[i * STREAM_COUNT + STREAM_ENVELOPE];
+        }
+        return std::fwrite(output.frames.data(), sizeof(float), 2 * streams, output.file) == 2 * streams;
+    }
+
+    for (std::size_t i = 0; i < streams; ++i) {
+        const float* frame = taps + i * STREAM_COUNT;
+        const char end = (i + 1) % channels == 0 ? '\n' : ',';
+        if (std::fprintf(output.file, "%.9g,%.9g%c", frame[STREAM_BANDPASSED], frame[STREAM_ENVELOPE], end) < 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool open_input(BatchInput& input, const char* path, SessionConfig& config) {
+    if (is_recording_path(path)) {
+        if (!input.recording.open(path)) {
+            return false;
+        }
+        // Viewer recordings hold STREAM_COUNT streams per source channel, raw first
+        const std::size_t channels = std::max<std::size_t>(1, input.recording.channels() / STREAM_COUNT);
+        bool changed = false;
+        if (channels != config.channels) {
+            LOG_INFO("%s holds %zu source channel(s); filtering each", path, channels);
+            config.channels = channels;
+            changed = true;
+        }
+        if (input.recording.sample_rate() != config.sample_rate) {
+            LOG_INFO("%s was recorded at %g Hz; filtering at that rate", path, input.recording.sample_rate());
+            config.sample_rate = input.recording.sample_rate();
+            changed = true;
+        }
+        return !changed || validate_session_config(config);
+    }
+
+    input.binary = has_extension(path, ".f32");
+    input.file = std::fopen(path, input.binary ? "rb" : "r");
+    if (!input.file) {
+        LOG_ERROR("Failed to open input file: %s", path);
+        return false;
+    }
+    std::setvbuf(input.file, nullptr, _IOFBF, BATCH_IO_BUFFER);
+    return true;
+}
+
+static bool open_output(BatchOutput& output, const char* path, const SessionConfig& config, std::size_t block_frames) {
+    if (is_recording_path(path)) {
+        RecordingSettings settings;
+        settings.sample_rate = config.sample_rate;
+        settings.channels = (std::uint32_t)(STREAM_COUNT * config.channels);
+        settings.highpass_cutoff = config.highpass_cutoff;
+        settings.bandpass_low = config.bandpass_low;
+        settings.bandpass_high = config.bandpass_high;
+        settings.lowpass_cutoff = config.lowpass_cutoff;
+        // Lossless: batch mode waits for the writer thread rather than dropping frames
+        return output.recording.open(path, settings, true);
+    }
+
+    output.binary = has_extension(path, ".f32");
+    output.file = std::fopen(path, output.binary ? "wb" : "w");
+    if (!output.file) {
+        LOG_ERROR("Failed to open output file: %s", path);
+        return false;
+    }
+    std::setvbuf(output.file, nullptr, _IOFBF, BATCH_IO_BUFFER);
+    if (output.binary) {
+        output.frames.resize(2 * block_frames * config.channels);
+        return true;
+    }
+    bool ok = true;
+    for (std::size_t c = 0; ok && c < config.channels; ++c) {
+        ok = config.channels == 1 ? std::fputs("filtered,envelope\n", output.file) >= 0
+                                  : std::fprintf(output.file, "filtered_%zu,envelope_%zu%c", c, c,
+                                                 c + 1 == config.channels ? '\n' : ',') >= 0;
+    }
+    if (!ok) {
+        LOG_ERROR("Failed to write output file: %s", path);
+        return false;
+    }
+    return true;
+}
+
+// Onset detector callback: count onsets into the std::size_t at context
+static void count_onset(void* context, const MuscleEvent& event) {
+    *static_cast<std::size_t*>(context) += event.type == MuscleEventType::Onset;
+}
+
+bool process_file(const char* input_path, const char* output_path, const SessionConfig& session, BatchStats& stats) {
+    auto start = batch_clock::now();
+    stats = BatchStats();
+
+    SessionConfig config = session;
+    BatchInput input;
+    BatchOutput output;
+    if (!open_input(input, input_path, config)) {
+        return false;
+    }
+
+    // The viewer's chain on every channel, split over a pool as the viewer splits it when there
+    // is more than one chunk; taps come out in RecordedStream order: raw, high-passed,
+    // band-passed, rectified, envelope
+    static_assert(ChainBank::TAPS == STREAM_COUNT, "Batch chain taps must match the recorded streams");
+    const std::size_t channels = config.channels;
+    stats.channels = channels;
+    stats.sample_rate = config.sample_rate;
+    const std::size_t block_frames = std::max<std::size_t>(1, BATCH_BLOCK_SIZE / channels);
+    const std::size_t chunks = ChannelScheduler::chunk_count(channels);
+    std::unique_ptr<ThreadPool> pool;
+    if (chunks > 1) {
+        std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        pool.reset(new ThreadPool(std::min(cores, chunks), false));
+    }
+    const std::size_t workers = pool ? pool->size() : 1;
+    ArenaSizer sizer;
+    ChannelScheduler::carve(sizer, config, block_frames, workers);
+    Arena arena(sizer.bytes());
+    if (!arena.is_valid()) {
+        LOG_ERROR("Failed to allocate %zu bytes for the filter chain", sizer.bytes());
+        if (input.file) {
+            std::fclose(input.file);
+        }
+        return false;
+    }
+    ChannelScheduler chain(config, block_frames, ChannelScheduler::carve(arena, config, block_frames, workers), pool.get());
+    chain.set_event_callback(count_onset, &stats.onsets);
+
+    bool opened = open_output(output, output_path, config, block_frames);
+
+    std::vector<float> scratch(block_frames * channels);
+    std::vector<float> taps(block_frames * channels * STREAM_COUNT);
+
+    batch_clock::duration filter_time(0);
+    bool write_failed = !opened;
+    while (!write_failed) {
+        const float* raw;
+        std::size_t n = read_samples(input, channels, scratch.data(), block_frames, raw);
+        if (n == 0) {
+            break;
+        }
+
+        auto filter_start = batch_clock::now();
+        chain.process(raw, n);
+        filter_time += batch_clock::now() - filter_start;
+        for (std::size_t t = 0; t < STREAM_COUNT; ++t) {
+            const float* tap = chain.tap(t);
+            for (std::size_t i = 0; i < n * channels; ++i) {
+                taps[i * STREAM_COUNT + t] = tap[i];
+            }
+        }
+
+        write_failed = !write_samples(output, channels, taps.data(), n);
+        stats.samples += n * channels;
+    }
+
+    bool read_failed = input.file && std::ferror(input.file) != 0;
+    if (input.file) {
+        std::fclose(input.file);
+    }
+    if (output.file) {
+        write_failed = std::fclose(output.file) != 0 || write_failed;
+    } else if (output.recording.is_open()) {
+        write_failed = !output.recording.close() || write_failed;
+    }
+    if (read_failed) {
+        LOG_ERROR("Failed to read input file: %s", input_path);
+    } else if (write_failed && opened) {
+        LOG_ERROR("Failed to write output file: %s", output_path);
+    }
+    bool ok = !read_failed && !write_failed;
+
+    stats.filter_seconds = std::chrono::duration<double>(filter_time).count();
+    stats.total_seconds = std::chrono::duration<double>(batch_clock::now() - start).count();
+    return ok;
+}
+
+static void print_usage() {
+    LOG_INFO("Usage: EMGSimulation --batch [--config <file>] [--<session option> <value> ...] "
+             "<input> <output> [<input> <output> ...]");
+    LOG_INFO("Session options are the viewer's (--sample-rate, --channels, --highpass, --bandpass-low, --bandpass-high, --lowpass, "
+             "--envelope, --envelope-window or --window-ms, --mains..., --onset...);");
+    LOG_INFO("Files ending in .f32 are raw float32 and .emgrec are recordings (input: each channel's raw stream; output:");
+    LOG_INFO("every stage); anything else is text with one frame per line, --channels values apart (output as CSV)");
+}
+
+int run_batch(int argc, char** argv, SessionConfig config) {
+    std::vector<const char*> paths;
+    for (int i = 0; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--", 2) != 0) {
+            paths.push_back(arg);
+            continue;
+        }
+        // The flag batch mode had before it shared the viewer's options
+        const char* name = std::strcmp(arg, "--window-ms") == 0 ? "envelope-window" : arg + 2;
+        if (std::strcmp(name, "config") != 0 && !is_session_option(name)) {
+            LOG_ERROR("Unknown option: %s", arg);
+            print_usage();
+            return -1;
+        }
+        if (i + 1 >= argc) {
+            LOG_ERROR("Missing value for %s", arg);
+            return -1;
+        }
+        bool ok = std::strcmp(name, "config") == 0 ? load_session_config(argv[++i], config)
+                                                   : set_session_option(config, name, argv[++i]);
+        if (!ok) {
+            return -1;
+        }
+    }
+
+    // channels is the frame width of .f32 and text inputs (recordings carry their own), and the
+    // envelope is written at full rate
+    config.display_channel = 0;
+    config.envelope_rate = 0.0f;
+    if (!validate_session_config(config)) {
+        return -1;
+    }
+
+    if (paths.empty() || paths.size() % 2 != 0) {
+        print_usage();
+        return -1;
+    }
+
+    if (config.envelope == EnvelopeType::LowPass) {
+        LOG_INFO("Batch processing at %g Hz: high-pass %g Hz, band-pass %g-%g Hz, envelope low-pass %g Hz",
+                 config.sample_rate, config.highpass_cutoff, config.bandpass_low, config.bandpass_high, config.lowpass_cutoff);
+    } else {
+        LOG_INFO("Batch processing at %g Hz: high-pass %g Hz, band-pass %g-%g Hz, moving %s envelope over %g ms",
+                 config.sample_rate, config.highpass_cutoff, config.bandpass_low, config.bandpass_high,
+                 envelope_type_name(config.envelope), config.envelope_window * 1000.0f);
+    }
+    if (config.mains_frequency > 0.0f) {
+        LOG_INFO("Power-line canceller: %g Hz and %zu harmonic(s), NLMS step %g", config.mains_frequency,
+                 config.mains_harmonics, config.mains_step);
+    }
+    if (config.onset_threshold > 0.0f) {
+        LOG_INFO("Counting muscle onsets on the %s above %g", config.onset_tkeo ? "TKEO" : "envelope",
+                 config.onset_threshold);
+    }
+
+    BatchStats total;
+    int failures = 0;
+    for (std::size_t i = 0; i < paths.size(); i += 2) {
+        BatchStats stats;
+        if (!process_file(paths[i], paths[i + 1], config, stats)) {
+            ++failures;
+            continue;
+        }
+        LOG_INFO("%s -> %s: %zu samples (%.1f s of signal) in %.3f s, %.1f M samples/s overall, %.1f M samples/s filtering",
+                 paths[i], paths[i + 1], stats.samples, stats.samples / stats.channels / stats.sample_rate, stats.total_seconds,
+                 stats.total_seconds > 0.0 ? stats.samples / stats.total_seconds / 1e6 : 0.0,
+                 stats.filter_seconds > 0.0 ? stats.samples / stats.filter_seconds / 1e6 : 0.0);
+        if (config.onset_threshold > 0.0f) {
+            LOG_INFO("%s: %zu muscle onsets across %zu channel(s)", paths[i], stats.onsets, stats.channels);
+        }
+        total.samples += stats.samples;
+        total.filter_seconds += stats.filter_seconds;
+        total.total_seconds += stats.total_seconds;
+    }
+
+    if (paths.size() > 2 && total.total_seconds > 0.0) {
+        LOG_INFO("Total: %zu samples in %.3f s, %.1f M samples/s", total.samples, total.total_seconds,
+                 total.samples / total.total_seconds / 1e6);
+    }
+    if (failures > 0) {
+        LOG_ERROR("%d of %zu files failed", failures, paths.size() / 2);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+
+#include <cstddef>
+#include "Session.h"
+
+// Totals for one processed file
+struct BatchStats {
+    std::size_t samples = 0; // Across every channel
+    std::size_t channels = 1;
+    float sample_rate = 0.0f; // The file's, for a recording, else the session's
+    std::size_t onsets = 0; // Muscle onsets detected, if the session sets an onset threshold
+    double filter_seconds = 0.0; // Time spent in the filter chain alone
+    double total_seconds = 0.0; // Wall time including file I/O
+};
+
+// Run a viewer session's chain (see ChainBank: power-line canceller, high-pass, band-pass,
+// envelope and onset detector, as the session configures them) over every channel of one
+// recording and write the filtered and envelope signals. Inputs wider than one
+// SCHEDULER_CHUNK_CHANNELS chunk are split over a thread pool (see ChannelScheduler), as in the
+// viewer. The session's envelope rate is a display setting and is ignored.
+// File formats are chosen by extension:
+// - .emgrec: a viewer recording, its source channels' raw streams (channel count and sample
+//   rate come from the file); output is every stage of every channel, as the viewer records it
+// - .f32: raw native-endian float32 frames of the session's channels; output is interleaved
+//   (filtered, envelope) pairs, a pair per channel per frame
+// - anything else: text, one frame per line with its channels separated by commas (lines with
+//   fewer numbers, such as headers, are skipped); output is CSV with a "filtered,envelope"
+//   header, or "filtered_<c>,envelope_<c>" column pairs for several channels
+bool process_file(const char* input_path, const char* output_path, const SessionConfig& config, BatchStats& stats);
+
+// Entry point for headless mode; args are everything after --batch.
+// Usage: [--config FILE] [--<session option> VALUE ...] <input> <output> [<input> <output> ...]
+// Options are the viewer's (see Session.h) and apply in order, so flags after --config override
+// the file; --window-ms is kept as another name for --envelope-window.
+// Returns the process exit code.
+int run_batch(int argc, char** argv, SessionConfig config);
+
+#endif // BATCH_PROCESSOR_H
@@ -0,0 +1,1473 @@
+// Benchmark.cpp
+// Standalone timing harness for the processing code (no GLFW required)
+// Usage: Benchmark [--list] [--filter <text>] [--json <file>]
+// - --list: Print the suite ids and exit
+// - --filter: Run only the suites whose id contains text
+// - --json: Also write every result to file, for comparing runs across builds and machines
+#include <vector>
+#include <random>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include "Filter.h"
+#include "CoefficientCache.h"
+#include "EMGGenerator.h"
+#include "RunningMax.h"
+#include "MinMaxPyramid.h"
+#include "MirroredRing.h"
+#include "FilterBank.h"
+#include "ChannelScheduler.h"
+#include "SosCascade.h"
+#include "PowerLineCanceller.h"
+#include "PolyphaseDecimator.h"
+#include "OnsetDetector.h"
+#include "Envelope.h"
+#include "Spectrum.h"
+#include "Pipeline.h"
+#include "Arena.h"
+#include "ChainBank.h"
+#include "Latency.h"
+#include <thread>
+
+const float SAMPLE_RATE = 2000.0f; // Hz, matches the simulation
+const std::size_t BENCH_SAMPLES = 1 << 22; // Samples pushed through each benchmark
+const std::size_t BLOCK_SIZE = 256; // Block length for the block API
+const std::size_t BANK_CHANNELS = 64; // Channel count for the multi-channel benchmarks
+const std::size_t ARRAY_CHANNELS = 256; // High-density array size for the thread pool benchmark
+
+// Keeps results observable so the optimizer can't discard the benchmarked work
+volatile float sink = 0.0f;
+
+// One timed measurement, kept for the JSON export
+struct BenchResult {
+    std::string suite; // Suite id
+    std::string name;
+    const char* unit; // What one item is: "sample" or "op"
+    double ns_per_item;
+    double items_per_second;
+};
+
+std::vector<BenchResult> results;
+std::string current_suite; // Id of the suite being run
+
+// Print a suite heading
+void begin_suite(const std::string& title) {
+    std::cout << "== " << title << " ==" << std::endl;
+}
+
+// Print and record one result in ns per item and items/s
+void report_items(const char* name, double seconds, std::size_t items, const char* unit) {
+    double ns_per_item = seconds * 1e9 / items;
+    double items_per_second = items / seconds;
+    std::cout << name << ": " << ns_per_item << " ns/" << unit << ", "
+              << items_per_second / 1e6 << " M " << unit << "s/s" << std::endl;
+    BenchResult result = { current_suite, name, unit, ns_per_item, items_per_second };
+    results.push_back(result);
+}
+
+// Print one result line in ns/sample and samples/s
+void report(const char* name, double seconds, std::size_t samples) {
+    report_items(name, seconds, samples, "sample");
+}
+
+// Print one result line in ns/op and ops/s, for calls that don't process samples
+void report_ops(const char* name, double seconds, std::size_t ops) {
+    report_items(name, seconds, ops, "op");
+}
+
+// Time a callable once and return elapsed seconds
+template <typename F>
+double time_it(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// The simulation's chain, one sample at a time
+double bench_chain_per_sample(const std::vector<float>& input, std::vector<float>& output) {
+    Filter highPassFilter(FilterType::HighPass, SAMPLE_RATE, 5.0f);
+    Filter bandPassFilter(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+    Filter lowPassFilter(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    return time_it([&] {
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            float x = highPassFilter.process(input[i]);
+            x = bandPassFilter.process(x);
+            x = rectify(x);
+            output[i] = lowPassFilter.process(x);
+        }
+    });
+}
+
+// The simulation's chain, one block per stage
+double bench_chain_block(const std::vector<float>& input, std::vector<float>& output) {
+    Filter highPassFilter(FilterType::HighPass, SAMPLE_RATE, 5.0f);
+    Filter bandPassFilter(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+    Filter lowPassFilter(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    return time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, input.size() - i);
+            float* out = output.data() + i;
+            highPassFilter.process(input.data() + i, out, n);
+            bandPassFilter.process(out, n);
+            rectify(out, out, n);
+            lowPassFilter.process(out, n);
+        }
+    });
+}
+
+void bench_filter_block_vs_per_sample() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    std::vector<float> per_sample_out(BENCH_SAMPLES);
+    std::vector<float> block_out(BENCH_SAMPLES);
+
+    // Warm up caches and clocks before timing
+    bench_chain_per_sample(input, per_sample_out);
+    double per_sample = bench_chain_per_sample(input, per_sample_out);
+    bench_chain_block(input, block_out);
+    double block = bench_chain_block(input, block_out);
+
+    float max_diff = 0.0f;
+    for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+        max_diff = std::max(max_diff, std::abs(per_sample_out[i] - block_out[i]));
+    }
+    sink = per_sample_out.back() + block_out.back();
+
+    begin_suite("Filter chain (highpass -> bandpass -> rectify -> lowpass)");
+    report("Per-sample process(float)", per_sample, BENCH_SAMPLES);
+    report("Block process(in, out, n)", block, BENCH_SAMPLES);
+    std::cout << "Speedup: " << per_sample / block << "x, max output difference: " << max_diff << std::endl;
+}
+
+// The viewer's chain (high-pass -> band-pass -> rectify -> double-precision low-pass) as one block
+// pass per stage through scratch buffers, against the same stages fused by Pipeline
+void bench_pipeline() {
+    const std::size_t block = 4096; // Larger than the viewer's blocks, so staging goes through L1 per stage
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(8642);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    Filter highPassFilter(FilterType::HighPass, SAMPLE_RATE, 5.0f);
+    Filter bandPassFilter(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+    PreciseFilter lowPassFilter(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    std::vector<float> highpassed(block), bandpassed(block), rectified(block);
+    std::vector<float> staged_out(BENCH_SAMPLES);
+    double staged = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += block) {
+            std::size_t n = std::min(block, input.size() - i);
+            highPassFilter.process(input.data() + i, highpassed.data(), n);
+            bandPassFilter.process(highpassed.data(), bandpassed.data(), n);
+            rectify(bandpassed.data(), rectified.data(), n);
+            lowPassFilter.process(rectified.data(), staged_out.data() + i, n);
+        }
+    });
+
+    Pipeline<Filter, Filter, Rectifier, PreciseFilter> chain(
+        Filter(FilterType::HighPass, SAMPLE_RATE, 5.0f), Filter(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f),
+        Rectifier(), PreciseFilter(FilterType::LowPass, SAMPLE_RATE, 2.0f));
+    std::vector<float> fused_out(BENCH_SAMPLES);
+    double fused = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += block) {
+            std::size_t n = std::min(block, input.size() - i);
+            chain.process(input.data() + i, fused_out.data() + i, n);
+        }
+    });
+
+    // Every tap, as the viewer and recorder take them
+    Pipeline<Filter, Filter, Rectifier, PreciseFilter> tapped_chain(
+        Filter(FilterType::HighPass, SAMPLE_RATE, 5.0f), Filter(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f),
+        Rectifier(), PreciseFilter(FilterType::LowPass, SAMPLE_RATE, 2.0f));
+    std::vector<float> taps(block * tapped_chain.TAPS);
+    float tap_diff = 0.0f;
+    double tapped = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += block) {
+            std::size_t n = std::min(block, input.size() - i);
+            tapped_chain.process_taps(input.data() + i, taps.data(), n);
+            tap_diff = std::max(tap_diff, std::abs(taps[(n - 1) * tapped_chain.TAPS + 4] - staged_out[i + n - 1]));
+        }
+    });
+
+    float max_diff = tap_diff;
+    for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+        max_diff = std::max(max_diff, std::abs(staged_out[i] - fused_out[i]));
+    }
+    sink = staged_out.back() + fused_out.back() + taps[0];
+
+    begin_suite("Pipeline fusion (highpass -> bandpass -> rectify -> lowpass)");
+    report("Stage by stage", staged, BENCH_SAMPLES);
+    report("Pipeline process", fused, BENCH_SAMPLES);
+    report("Pipeline process_taps (5 taps)", tapped, BENCH_SAMPLES);
+    std::cout << "Speedup: " << staged / fused << "x, max output difference: " << max_diff << std::endl;
+}
+
+// Time one filter variant over the input in blocks, then measure its error against the reference
+template <typename F>
+void bench_filter_form(const char* name, const std::vector<float>& input, const std::vector<double>& reference) {
+    F filter(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    std::vector<float> output(input.size());
+    double seconds = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, input.size() - i);
+            filter.process(input.data() + i, output.data() + i, n);
+        }
+    });
+
+    double max_error = 0.0, error_energy = 0.0, energy = 0.0;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        double error = output[i] - reference[i];
+        max_error = std::max(max_error, std::abs(error));
+        error_energy += error * error;
+        energy += reference[i] * reference[i];
+    }
+    sink = output.back();
+
+    report(name, seconds, input.size());
+    std::cout << "  max error: " << max_error << ", error relative to signal: "
+              << 10.0 * std::log10(error_energy / energy) << " dB" << std::endl;
+}
+
+// Topology and state precision at the envelope low-pass (2 Hz at 2 kHz), where the poles sit
+// closest to z = 1. The input is rectified noise, so the filter mostly carries DC, as it does on
+// the rectified EMG. The reference is a long double DF-I with long double coefficients.
+void bench_filter_forms() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = std::abs(dist(gen));
+    }
+
+    const long double pi = 3.14159265358979323846264338327950288L;
+    const long double omega = 2.0L * pi * 2.0L / SAMPLE_RATE;
+    const long double alpha = std::sin(omega) / 2.0L;
+    const long double a0 = 1.0L + alpha;
+    const long double b0 = (1.0L - std::cos(omega)) / 2.0L / a0, b1 = 2.0L * b0, b2 = b0;
+    const long double a1 = -2.0L * std::cos(omega) / a0, a2 = (1.0L - alpha) / a0;
+    std::vector<double> reference(BENCH_SAMPLES);
+    long double x1 = 0.0L, x2 = 0.0L, y1 = 0.0L, y2 = 0.0L;
+    for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+        long double y = b0 * input[i] + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = input[i];
+        y2 = y1;
+        y1 = y;
+        reference[i] = (double)y;
+    }
+
+    begin_suite("Biquad forms at a 2 Hz low-pass");
+    bench_filter_form<BasicFilter<BiquadForm::DirectForm1, float>>("DF-I float", input, reference);
+    bench_filter_form<BasicFilter<BiquadForm::TransposedDirectForm2, float>>("TDF-II float", input, reference);
+    bench_filter_form<BasicFilter<BiquadForm::DirectForm1, double>>("DF-I double", input, reference);
+    bench_filter_form<BasicFilter<BiquadForm::TransposedDirectForm2, double>>("TDF-II double", input, reference);
+}
+
+void bench_filter_bank() {
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::mt19937 gen(5678);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    // Reference: one Filter chain per channel, block API on de-interleaved data
+    std::vector<float> reference(input.size());
+    std::vector<float> channel(frames);
+    std::vector<Filter> highPass, bandPass, lowPass;
+    for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+        highPass.emplace_back(FilterType::HighPass, SAMPLE_RATE, 5.0f);
+        bandPass.emplace_back(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+        lowPass.emplace_back(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    }
+    double per_channel = time_it([&] {
+        for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+            for (std::size_t f = 0; f < frames; ++f) {
+                channel[f] = input[f * BANK_CHANNELS + c];
+            }
+            highPass[c].process(channel.data(), frames);
+            bandPass[c].process(channel.data(), frames);
+            rectify(channel.data(), channel.data(), frames);
+            lowPass[c].process(channel.data(), frames);
+            for (std::size_t f = 0; f < frames; ++f) {
+                reference[f * BANK_CHANNELS + c] = channel[f];
+            }
+        }
+    });
+
+    // SIMD bank: the same chain across all channels at once
+    std::vector<float> output(input.size());
+    FilterBank<BANK_CHANNELS> highPassBank(FilterType::HighPass, SAMPLE_RATE, 5.0f);
+    FilterBank<BANK_CHANNELS> bandPassBank(FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+    FilterBank<BANK_CHANNELS> lowPassBank(FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    double bank = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            const float* in = input.data() + f * BANK_CHANNELS;
+            float* out = output.data() + f * BANK_CHANNELS;
+            highPassBank.process(in, out, n);
+            bandPassBank.process(out, n);
+            rectify(out, out, n * BANK_CHANNELS);
+            lowPassBank.process(out, n);
+        }
+    });
+
+    // Runtime-sized bank
+    FilterBank<> highPassDynamic(BANK_CHANNELS, FilterType::HighPass, SAMPLE_RATE, 5.0f);
+    FilterBank<> bandPassDynamic(BANK_CHANNELS, FilterType::BandPass, SAMPLE_RATE, 5.0f, 50.0f);
+    FilterBank<> lowPassDynamic(BANK_CHANNELS, FilterType::LowPass, SAMPLE_RATE, 2.0f);
+    std::vector<float> dynamic_output(input.size());
+    double dynamic = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            const float* in = input.data() + f * BANK_CHANNELS;
+            float* out = dynamic_output.data() + f * BANK_CHANNELS;
+            highPassDynamic.process(in, out, n);
+            bandPassDynamic.process(out, n);
+            rectify(out, out, n * BANK_CHANNELS);
+            lowPassDynamic.process(out, n);
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        max_diff = std::max(max_diff, std::abs(reference[i] - output[i]));
+        max_diff = std::max(max_diff, std::abs(reference[i] - dynamic_output[i]));
+    }
+    sink = output.back() + dynamic_output.back();
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel chain, FilterBank (" + simd::ISA_NAME + ")");
+    report("Per-channel Filter objects", per_channel, input.size());
+    report("FilterBank<64>", bank, input.size());
+    report("FilterBank<DYNAMIC_CHANNELS>", dynamic, input.size());
+    double realtime_load = bank / input.size() * BANK_CHANNELS * SAMPLE_RATE;
+    std::cout << "Speedup: " << per_channel / bank << "x, max output difference: " << max_diff
+              << ", core load at " << SAMPLE_RATE << " Hz: " << realtime_load * 100.0 << "%" << std::endl;
+}
+
+// The viewer's acquisition path over BANK_CHANNELS channels: every tap of every channel, then
+// one channel's taps gathered for display
+void bench_chain_bank() {
+    const std::size_t block = 64; // The viewer's ACQUISITION_BLOCK_SIZE
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    SessionConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    config.channels = BANK_CHANNELS;
+    const std::size_t display = BANK_CHANNELS / 2;
+
+    // One fused Pipeline per channel, fed a de-interleaved copy of its channel
+    typedef Pipeline<Filter, Filter, Rectifier, EnvelopeDetector> Chain;
+    std::vector<Chain> chains(BANK_CHANNELS, Chain(
+        Filter(FilterType::HighPass, SAMPLE_RATE, config.highpass_cutoff),
+        Filter(FilterType::BandPass, SAMPLE_RATE, config.bandpass_low, config.bandpass_high), Rectifier(),
+        EnvelopeDetector(config.envelope, SAMPLE_RATE, config.lowpass_cutoff, config.envelope_window)));
+    std::vector<float> channel(block), taps(block * Chain::TAPS);
+    std::vector<float> reference(frames * Chain::TAPS);
+    double per_channel = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += block) {
+            std::size_t n = std::min(block, frames - f);
+            for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    channel[i] = input[(f + i) * BANK_CHANNELS + c];
+                }
+                chains[c].process_taps(channel.data(), taps.data(), n);
+                if (c == display) {
+                    std::copy(taps.begin(), taps.begin() + n * Chain::TAPS, reference.begin() + f * Chain::TAPS);
+                }
+            }
+        }
+    });
+
+    // ChainBank on arena storage, straight from the interleaved frames
+    ArenaSizer sizer;
+    ChainBank::carve(sizer, config, block);
+    Arena arena(sizer.bytes());
+    ChainBank bank(config, block, ChainBank::carve(arena, config, block));
+    std::vector<float> output(frames * ChainBank::TAPS);
+    double banked = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += block) {
+            std::size_t n = std::min(block, frames - f);
+            bank.process(input.data() + f * BANK_CHANNELS, n);
+            for (std::size_t t = 0; t < ChainBank::TAPS; ++t) {
+                const float* tap = bank.tap(t) + display;
+                for (std::size_t i = 0; i < n; ++i) {
+                    output[(f + i) * ChainBank::TAPS + t] = tap[i * BANK_CHANNELS];
+                }
+            }
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (std::size_t i = 0; i < output.size(); ++i) {
+        max_diff = std::max(max_diff, std::abs(reference[i] - output[i]));
+    }
+    sink = output.back() + reference.back();
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel viewer chain, " + std::to_string(block) + "-frame blocks");
+    report("Pipeline per channel", per_channel, input.size());
+    report("ChainBank", banked, input.size());
+    std::cout << "Speedup: " << per_channel / banked << "x, max tap difference: " << max_diff
+              << ", arena: " << arena.bytes_used() << " bytes" << std::endl;
+}
+
+// Cost of the latency instrumentation: a histogram record, a scoped timer, and the viewer's
+// chain with and without per-stage timers
+void bench_latency() {
+    const std::size_t ops = BENCH_SAMPLES / 4;
+    static LatencyHistogram histogram; // Too large for the stack in some debug builds
+    std::mt19937 gen(6060);
+    std::vector<std::int64_t> values(4096);
+    std::lognormal_distribution<double> dist(9.0, 1.5); // Microseconds to milliseconds
+    for (std::int64_t& v : values) {
+        v = (std::int64_t)dist(gen);
+    }
+    double recording = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            histogram.record(values[i & (values.size() - 1)]);
+        }
+    });
+    double timing = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            ScopedTimer timer(histogram);
+        }
+    });
+
+    const std::size_t block = 64;
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::uniform_real_distribution<float> samples(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = samples(gen);
+    }
+    SessionConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    config.channels = BANK_CHANNELS;
+    ArenaSizer sizer;
+    ChainBank::carve(sizer, config, block);
+    Arena arena(sizer.bytes());
+    ChainBank bank(config, block, ChainBank::carve(arena, config, block));
+    auto run_chain = [&] {
+        for (std::size_t f = 0; f < frames; f += block) {
+            bank.process(input.data() + f * BANK_CHANNELS, std::min(block, frames - f));
+        }
+    };
+    static LatencyStage stages[ChainBank::TIMED_STAGES] = {
+        { "mains" }, { "highpass" }, { "bandpass" }, { "rectify" }, { "envelope" }, { "onset" },
+    };
+    // The difference is a few percent at most, below one run's noise, so each line is the
+    // fastest of several interleaved runs and the overhead is worked out from the timer's parts
+    const int passes = 7;
+    run_chain(); // Warm up, so neither timed run pays for first touches
+    double untimed = 1e30, timed = 1e30;
+    for (int pass = 0; pass < passes; ++pass) {
+        bank.set_stage_timers(nullptr);
+        untimed = std::min(untimed, time_it(run_chain));
+        bank.set_stage_timers(stages);
+        timed = std::min(timed, time_it(run_chain));
+    }
+    const std::size_t blocks = (frames + block - 1) / block;
+    sink = bank.tap(4)[0] + (float)histogram.percentile(0.99) + (float)stages[4].histogram.percentile(0.99);
+
+    begin_suite("Latency instrumentation");
+    report_ops("LatencyHistogram::record", recording, ops);
+    report_ops("ScopedTimer (two clock reads and a record)", timing, ops);
+    report(("ChainBank, " + std::to_string(BANK_CHANNELS) + " channels, untimed").c_str(), untimed, input.size());
+    report(("ChainBank, " + std::to_string(BANK_CHANNELS) + " channels, per-stage timers").c_str(), timed, input.size());
+    // Each block reads the clock once to start and once per lap, and records every lap; the
+    // default chain laps high-pass, band-pass, rectify and envelope
+    const std::size_t laps = 4;
+    const double record_ns = recording * 1e9 / ops;
+    const double clock_ns = (timing * 1e9 / ops - record_ns) / 2.0;
+    const double per_block = (laps + 1) * clock_ns + laps * record_ns;
+    std::cout << "Timer cost: " << per_block << " ns per " << block << "-frame block (" << laps + 1 << " clock reads, "
+              << laps << " records), " << per_block / (untimed * 1e9 / blocks) * 100.0 << "% of the untimed chain; "
+              << "envelope stage p99: " << stages[4].histogram.percentile(0.99) << " ns" << std::endl;
+}
+
+// 50 Hz hum with two harmonics over broadband "EMG" on BANK_CHANNELS channels: the adaptive
+// canceller against a cascade of fixed notches at the same frequencies. The error is the output's
+// difference from the clean signal once both have settled, so it counts hum left behind and any
+// EMG the notches take out or smear.
+void bench_power_line() {
+    const std::size_t harmonics = 3;
+    const float mains = 50.0f;
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> clean(frames * BANK_CHANNELS), input(frames * BANK_CHANNELS);
+    std::mt19937 gen(5060);
+    std::normal_distribution<float> emg(0.0f, 0.1f);
+    for (std::size_t f = 0; f < frames; ++f) {
+        double t = f / SAMPLE_RATE;
+        for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+            float hum = 0.0f;
+            for (std::size_t h = 1; h <= harmonics; ++h) {
+                hum += (float)(0.3 / h * std::sin(2.0 * 3.14159265358979 * mains * h * t + 0.1 * c * h));
+            }
+            clean[f * BANK_CHANNELS + c] = emg(gen);
+            input[f * BANK_CHANNELS + c] = clean[f * BANK_CHANNELS + c] + hum;
+        }
+    }
+
+    std::vector<float> storage(PowerLineCanceller::storage_floats(BANK_CHANNELS, harmonics));
+    PowerLineCanceller canceller(BANK_CHANNELS, SAMPLE_RATE, mains, harmonics, 0.01f, storage.data());
+    std::vector<float> cancelled(input.size());
+    double adaptive = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            canceller.process(input.data() + f * BANK_CHANNELS, cancelled.data() + f * BANK_CHANNELS, n);
+        }
+    });
+
+    std::vector<FilterBank<>> notches;
+    for (std::size_t h = 1; h <= harmonics; ++h) {
+        notches.emplace_back(BANK_CHANNELS, design_notch(SAMPLE_RATE, mains * h));
+    }
+    std::vector<float> notched(input.size());
+    double fixed = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            notches[0].process(input.data() + f * BANK_CHANNELS, notched.data() + f * BANK_CHANNELS, n);
+            for (std::size_t h = 1; h < harmonics; ++h) {
+                notches[h].process(notched.data() + f * BANK_CHANNELS, n);
+            }
+        }
+    });
+
+    // Error power over the second half, relative to the hum that went in
+    auto error_db = [&](const std::vector<float>& out) {
+        double error = 0.0, hum = 0.0;
+        for (std::size_t i = input.size() / 2; i < input.size(); ++i) {
+            double e = out[i] - clean[i], h = input[i] - clean[i];
+            error += e * e;
+            hum += h * h;
+        }
+        return 10.0 * std::log10(error / hum);
+    };
+    sink = cancelled.back() + notched.back();
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel 50 Hz hum + 2 harmonics (" + simd::ISA_NAME + ")");
+    report("PowerLineCanceller (6 NLMS taps)", adaptive, input.size());
+    report("Notch cascade (3 biquads, Q 30)", fixed, input.size());
+    std::cout << "Error vs clean signal, relative to the hum: canceller " << error_db(cancelled) << " dB, notches "
+              << error_db(notched) << " dB; speedup " << fixed / adaptive << "x" << std::endl;
+}
+
+// A 2 kHz envelope on BANK_CHANNELS channels down to 50 and 60 Hz: PolyphaseDecimator, which
+// computes only the output samples it keeps, against running the same filter at the up-sampled
+// rate on every sample (zero-stuffed input) and keeping one in down
+void bench_decimator() {
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::mt19937 gen(4321);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<float> level(BANK_CHANNELS, 0.0f);
+    for (std::size_t f = 0; f < frames; ++f) {
+        for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+            level[c] += 0.01f * (dist(gen) - level[c]); // Slowly wandering, like an envelope
+            input[f * BANK_CHANNELS + c] = level[c];
+        }
+    }
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel envelope decimation from 2 kHz (" + simd::ISA_NAME + ")");
+    const float rates[] = { 50.0f, 60.0f };
+    for (float rate : rates) {
+        const std::size_t block_out = PolyphaseDecimator::max_output(SAMPLE_RATE, rate, BLOCK_SIZE);
+        std::vector<float> polyphase_out((frames / BLOCK_SIZE + 1) * block_out * BANK_CHANNELS);
+        PolyphaseDecimator decimator(BANK_CHANNELS, SAMPLE_RATE, rate, BLOCK_SIZE);
+        std::size_t outputs = 0;
+        double polyphase = time_it([&] {
+            for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+                std::size_t n = std::min(BLOCK_SIZE, frames - f);
+                outputs += decimator.process(input.data() + f * BANK_CHANNELS, n,
+                                             polyphase_out.data() + outputs * BANK_CHANNELS);
+            }
+        });
+
+        // Every up-sampled instant t = i * up + p is filtered through branch p; only those on
+        // the output grid (t a multiple of down) are kept
+        const std::size_t up = decimator.up_factor(), down = decimator.down_factor(), taps = decimator.taps();
+        std::vector<float> direct_out(polyphase_out.size());
+        std::vector<float> padded((taps - 1 + frames) * BANK_CHANNELS, 0.0f);
+        std::copy(input.begin(), input.end(), padded.begin() + (taps - 1) * BANK_CHANNELS);
+        std::size_t kept = 0;
+        double direct = time_it([&] {
+            using namespace simd;
+            for (std::size_t i = 0; i < frames; ++i) {
+                for (std::size_t p = 0; p < up; ++p) {
+                    const float* branch = decimator.branch(p);
+                    const float* newest = padded.data() + (taps - 1 + i) * BANK_CHANNELS;
+                    vfloat acc[BANK_CHANNELS / WIDTH];
+                    for (std::size_t c = 0; c < BANK_CHANNELS; c += WIDTH) {
+                        acc[c / WIDTH] = mul(set1(branch[0]), load(newest + c));
+                    }
+                    for (std::size_t k = 1; k < taps; ++k) {
+                        vfloat tap = set1(branch[k]);
+                        const float* row = newest - k * BANK_CHANNELS;
+                        for (std::size_t c = 0; c < BANK_CHANNELS; c += WIDTH) {
+                            acc[c / WIDTH] = add(acc[c / WIDTH], mul(tap, load(row + c)));
+                        }
+                    }
+                    if ((i * up + p) % down == 0) {
+                        for (std::size_t c = 0; c < BANK_CHANNELS; c += WIDTH) {
+                            store(direct_out.data() + kept * BANK_CHANNELS + c, acc[c / WIDTH]);
+                        }
+                        ++kept;
+                    }
+                }
+            }
+        });
+
+        float max_diff = 0.0f;
+        for (std::size_t i = 0; i < std::min(outputs, kept) * BANK_CHANNELS; ++i) {
+            max_diff = std::max(max_diff, std::abs(polyphase_out[i] - direct_out[i]));
+        }
+        sink = polyphase_out[0] + direct_out[0];
+
+        std::string label = std::to_string((int)rate) + " Hz (" + std::to_string(up) + "/" + std::to_string(down) +
+                            ", " + std::to_string(taps) + " taps per branch)";
+        report(("PolyphaseDecimator to " + label).c_str(), polyphase, frames * BANK_CHANNELS);
+        report(("Filter every sample, keep 1 in " + std::to_string(down)).c_str(), direct, frames * BANK_CHANNELS);
+        std::cout << "Speedup: " << direct / polyphase << "x, " << outputs << " of " << frames
+                  << " frames kept, max difference " << max_diff << std::endl;
+    }
+}
+
+// Collects what an OnsetDetector reports, for bench_onset
+struct EventLog {
+    std::vector<MuscleEvent> events;
+    static void collect(void* context, const MuscleEvent& event) { static_cast<EventLog*>(context)->events.push_back(event); }
+};
+
+// Bursts of 10x the resting amplitude, 200 ms long once a second, staggered across
+// BANK_CHANNELS channels, through ChainBank with the onset detector watching the envelope
+// and then the TKEO. Thresholds sit between each signal's resting and burst levels; the
+// delay is from the true start of a burst to the onset firing.
+void bench_onset() {
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    const std::size_t period = (std::size_t)SAMPLE_RATE, burst = period / 5, block = 64;
+    auto burst_start = [&](std::size_t c) { return (c * 137) % (period - burst); };
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::mt19937 gen(2929);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (std::size_t f = 0; f < frames; ++f) {
+        for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+            std::size_t phase = (f + period - burst_start(c)) % period;
+            input[f * BANK_CHANNELS + c] = (phase < burst ? 0.5f : 0.05f) * noise(gen);
+        }
+    }
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel onset detection, 5 ms hold");
+    const bool modes[] = { false, true };
+    for (bool tkeo : modes) {
+        SessionConfig config;
+        config.sample_rate = SAMPLE_RATE;
+        config.channels = BANK_CHANNELS;
+
+        // Mean detection signal at rest and mid-burst, with no detector running
+        double rest = 0.0, active = 0.0;
+        std::size_t rest_count = 0, active_count = 0;
+        {
+            ArenaSizer sizer;
+            ChainBank::carve(sizer, config, block);
+            Arena arena(sizer.bytes());
+            ChainBank bank(config, block, ChainBank::carve(arena, config, block));
+            std::vector<float> previous(BANK_CHANNELS, 0.0f), current(BANK_CHANNELS, 0.0f), smoothed(BANK_CHANNELS, 0.0f);
+            const float a = (float)(1.0 - std::exp(-2.0 * 3.14159265358979 * OnsetDetector::TKEO_SMOOTHING_HZ / SAMPLE_RATE));
+            for (std::size_t f = 0; f < frames; f += block) {
+                std::size_t n = std::min(block, frames - f);
+                bank.process(input.data() + f * BANK_CHANNELS, n);
+                for (std::size_t i = 0; i < n; ++i) {
+                    for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+                        float level = bank.tap(4)[i * BANK_CHANNELS + c];
+                        if (tkeo) {
+                            float x = bank.tap(2)[i * BANK_CHANNELS + c];
+                            smoothed[c] += a * (std::abs(current[c] * current[c] - previous[c] * x) - smoothed[c]);
+                            previous[c] = current[c];
+                            current[c] = x;
+                            level = smoothed[c];
+                        }
+                        std::size_t phase = (f + i + period - burst_start(c)) % period;
+                        if (phase >= burst / 2 && phase < burst) {
+                            active += level;
+                            ++active_count;
+                        } else if (phase >= burst + period / 4 && phase < period - period / 8) {
+                            rest += level;
+                            ++rest_count;
+                        }
+                    }
+                }
+            }
+        }
+        rest /= rest_count;
+        active /= active_count;
+        config.onset_threshold = (float)std::sqrt(rest * active);
+        config.offset_threshold = (float)std::sqrt(rest * config.onset_threshold);
+        config.onset_tkeo = tkeo;
+
+        ArenaSizer sizer;
+        ChainBank::carve(sizer, config, block);
+        Arena arena(sizer.bytes());
+        ChainBank bank(config, block, ChainBank::carve(arena, config, block));
+        EventLog log;
+        log.events.reserve(frames);
+        bank.set_event_callback(EventLog::collect, &log);
+        double elapsed = time_it([&] {
+            for (std::size_t f = 0; f < frames; f += block) {
+                bank.process(input.data() + f * BANK_CHANNELS, std::min(block, frames - f));
+            }
+        });
+
+        // Match each onset to the burst it fired in (or just after)
+        std::size_t hits = 0, spurious = 0;
+        double total_delay = 0.0, worst_delay = 0.0;
+        for (const MuscleEvent& event : log.events) {
+            if (event.type != MuscleEventType::Onset) {
+                continue;
+            }
+            std::size_t since = (event.detected + period - burst_start(event.channel)) % period;
+            if (since < burst + period / 4) {
+                double delay = since * 1000.0 / SAMPLE_RATE;
+                total_delay += delay;
+                worst_delay = std::max(worst_delay, delay);
+                ++hits;
+            } else {
+                ++spurious;
+            }
+        }
+        std::size_t bursts = 0;
+        for (std::size_t c = 0; c < BANK_CHANNELS; ++c) {
+            bursts += (frames + period - 1 - burst_start(c)) / period;
+        }
+
+        report(tkeo ? "ChainBank + TKEO onset detector" : "ChainBank + envelope onset detector", elapsed,
+               frames * BANK_CHANNELS);
+        std::cout << "  thresholds " << config.onset_threshold << " / " << config.offset_threshold << ": " << hits
+                  << " of " << bursts << " bursts, " << spurious << " spurious, delay mean "
+                  << (hits ? total_delay / hits : 0.0) << " ms, max " << worst_delay << " ms" << std::endl;
+    }
+}
+
+// Samples until a detector's response to a unit step stays within 5% of its final value
+template <typename F>
+std::size_t settling_samples(F&& detector) {
+    const std::size_t length = (std::size_t)SAMPLE_RATE * 4;
+    std::vector<float> step(length, 1.0f), rectified(length), envelope(length);
+    detector.process(step.data(), rectified.data(), envelope.data(), length);
+    std::size_t settled = length;
+    while (settled > 0 && std::abs(envelope[settled - 1] - 1.0f) <= 0.05f) {
+        --settled;
+    }
+    return settled;
+}
+
+// Envelope detectors on one channel, and the SIMD moving-RMS bank against per-channel detectors
+void bench_envelopes() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(1357);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    begin_suite("Envelope detectors (100 ms window)");
+    const EnvelopeType types[] = { EnvelopeType::LowPass, EnvelopeType::MovingAverage, EnvelopeType::MovingRms };
+    std::vector<float> rectified(BENCH_SAMPLES), envelope(BENCH_SAMPLES);
+    for (EnvelopeType type : types) {
+        EnvelopeDetector detector(type, SAMPLE_RATE, 2.0f, 0.1f);
+        double seconds = time_it([&] {
+            for (std::size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+                std::size_t n = std::min(BLOCK_SIZE, input.size() - i);
+                detector.process(input.data() + i, rectified.data() + i, envelope.data() + i, n);
+            }
+        });
+        sink = envelope.back();
+        report(envelope_type_name(type), seconds, BENCH_SAMPLES);
+        std::cout << "  settles to 5% of a step in "
+                  << settling_samples(EnvelopeDetector(type, SAMPLE_RATE, 2.0f, 0.1f)) * 1000.0f / SAMPLE_RATE << " ms";
+        if (type == EnvelopeType::MovingRms) {
+            // Drift check: the compensated running sum against the exact RMS of the last window
+            const std::size_t window = envelope_window_samples(SAMPLE_RATE, 0.1f);
+            double exact = 0.0;
+            for (std::size_t i = BENCH_SAMPLES - window; i < BENCH_SAMPLES; ++i) {
+                exact += (double)input[i] * input[i];
+            }
+            exact = std::sqrt(exact / window);
+            std::cout << ", relative error after " << BENCH_SAMPLES << " samples: "
+                      << std::abs(envelope.back() - exact) / exact;
+        }
+        std::cout << std::endl;
+    }
+
+    // 64 channels of moving RMS: one detector per channel on de-interleaved data vs one bank
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    const std::size_t window = envelope_window_samples(SAMPLE_RATE, 0.1f);
+    std::vector<float> planar(frames * BANK_CHANNELS);
+    for (std::size_t ch = 0; ch < BANK_CHANNELS; ++ch) {
+        for (std::size_t f = 0; f < frames; ++f) {
+            planar[ch * frames + f] = input[f * BANK_CHANNELS + ch];
+        }
+    }
+    std::vector<MovingEnvelope> per_channel(BANK_CHANNELS, MovingEnvelope(EnvelopeType::MovingRms, window));
+    std::vector<float> planar_out(planar.size());
+    double separate = time_it([&] {
+        for (std::size_t ch = 0; ch < BANK_CHANNELS; ++ch) {
+            per_channel[ch].process(planar.data() + ch * frames, planar_out.data() + ch * frames, frames);
+        }
+    });
+
+    MovingEnvelopeBank bank(BANK_CHANNELS, EnvelopeType::MovingRms, window);
+    std::vector<float> bank_out(frames * BANK_CHANNELS);
+    double banked = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            bank.process(input.data() + f * BANK_CHANNELS, bank_out.data() + f * BANK_CHANNELS, n);
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (std::size_t ch = 0; ch < BANK_CHANNELS; ++ch) {
+        for (std::size_t f = 0; f < frames; ++f) {
+            max_diff = std::max(max_diff, std::abs(planar_out[ch * frames + f] - bank_out[f * BANK_CHANNELS + ch]));
+        }
+    }
+    sink = planar_out.back() + bank_out.back();
+
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel moving RMS, MovingEnvelopeBank (" + simd::ISA_NAME + ")");
+    report("Per-channel MovingEnvelope", separate, frames * BANK_CHANNELS);
+    report("MovingEnvelopeBank", banked, frames * BANK_CHANNELS);
+    std::cout << "Speedup: " << separate / banked << "x, max output difference: " << max_diff << std::endl;
+}
+
+// Streaming spectral analysis (1024-sample windows, 50% overlap) across a 64-channel array
+void bench_spectral_analysis() {
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> input(frames * BANK_CHANNELS);
+    std::mt19937 gen(9753);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    SpectralAnalyzer analyzer(BANK_CHANNELS, SAMPLE_RATE, 1024, 512);
+    std::size_t spectra = 0;
+    double seconds = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, frames - f);
+            spectra += analyzer.process(input.data() + f * BANK_CHANNELS, n);
+        }
+    });
+    sink = analyzer.result(0).median_frequency;
+
+    // White noise: mean and median both sit at a quarter of the sample rate
+    double median = 0.0;
+    for (std::size_t ch = 0; ch < BANK_CHANNELS; ++ch) {
+        median += analyzer.result(ch).median_frequency;
+    }
+    median /= BANK_CHANNELS;
+
+    double realtime_rate = SAMPLE_RATE * BANK_CHANNELS;
+    begin_suite(std::to_string(BANK_CHANNELS) + "-channel spectral analysis (1024-point FFT, hop 512)");
+    report("SpectralAnalyzer", seconds, frames * BANK_CHANNELS);
+    std::cout << "  " << spectra * BANK_CHANNELS / seconds << " spectra/s, core load at " << SAMPLE_RATE
+              << " Hz: " << realtime_rate * seconds / (frames * BANK_CHANNELS) * 100.0
+              << "%, mean median frequency on white noise: " << median << " Hz" << std::endl;
+}
+
+// 8th-order Butterworth band-pass (20-450 Hz, four sections) plus a 50 Hz notch,
+// as separate Filter objects versus one SosCascade<5>
+void bench_sos_cascade() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(3456);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    std::vector<BiquadCoefficients> design = design_butterworth(FilterType::BandPass, 4, SAMPLE_RATE, 20.0f, 450.0f);
+    design.push_back(design_notch(SAMPLE_RATE, 50.0f));
+
+    std::vector<Filter> chained(design.size(), Filter(FilterType::LowPass, SAMPLE_RATE, 1.0f));
+    for (std::size_t k = 0; k < design.size(); ++k) {
+        chained[k].set_coefficients(design[k]);
+    }
+    std::vector<float> chained_out(BENCH_SAMPLES);
+    double separate = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, input.size() - i);
+            chained[0].process(input.data() + i, chained_out.data() + i, n);
+            for (std::size_t k = 1; k < chained.size(); ++k) {
+                chained[k].process(chained_out.data() + i, n);
+            }
+        }
+    });
+
+    SosCascade<5> cascade(design);
+    std::vector<float> cascade_out(BENCH_SAMPLES);
+    double fused = time_it([&] {
+        for (std::size_t i = 0; i < input.size(); i += BLOCK_SIZE) {
+            std::size_t n = std::min(BLOCK_SIZE, input.size() - i);
+            cascade.process(input.data() + i, cascade_out.data() + i, n);
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+        max_diff = std::max(max_diff, std::abs(chained_out[i] - cascade_out[i]));
+    }
+    sink = chained_out.back() + cascade_out.back();
+
+    begin_suite("8th-order Butterworth band-pass + 50 Hz notch (5 sections)");
+    report("Chained Filter objects", separate, BENCH_SAMPLES);
+    report("SosCascade<5>", fused, BENCH_SAMPLES);
+    std::cout << "Speedup: " << separate / fused << "x, max output difference: " << max_diff << std::endl;
+}
+
+// Designing coefficients: a full Filter construction, the bare design, and CoefficientCache
+// lookups (the key handler's path once a cutoff has been seen)
+void bench_filter_design() {
+    const std::size_t ops = 1 << 18;
+    const float cutoffs[] = { 5.0f, 5.5f, 6.0f, 6.5f, 7.0f, 7.5f, 8.0f, 8.5f };
+
+    double constructed = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            Filter filter(FilterType::BandPass, SAMPLE_RATE, cutoffs[i % 8], 50.0f);
+            sink = filter.process(1.0f);
+        }
+    });
+
+    double designed = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            sink = design_biquad(FilterType::BandPass, SAMPLE_RATE, cutoffs[i % 8], 50.0f).b0;
+        }
+    });
+
+    CoefficientCache cache;
+    cache.prepopulate_freq1(FilterType::BandPass, SAMPLE_RATE, cutoffs[0], cutoffs[7], 0.5f, 50.0f);
+    double hits = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            sink = cache.get(FilterType::BandPass, SAMPLE_RATE, cutoffs[i % 8], 50.0f).b0;
+        }
+    });
+
+    // Every key new, so each get() designs and stores, and each lookup() designs only
+    CoefficientCache cold;
+    double misses = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            sink = cold.get(FilterType::BandPass, SAMPLE_RATE, 5.0f + i * 0.001f, 50.0f).b0;
+        }
+    });
+    double lookup_misses = time_it([&] {
+        for (std::size_t i = 0; i < ops; ++i) {
+            sink = cache.lookup(FilterType::BandPass, SAMPLE_RATE, 5.0f + i * 0.001f, 60.0f).b0;
+        }
+    });
+
+    begin_suite("Band-pass coefficient design");
+    report_ops("Filter constructor", constructed, ops);
+    report_ops("design_biquad", designed, ops);
+    report_ops("CoefficientCache hit", hits, ops);
+    report_ops("CoefficientCache miss (get, stored)", misses, ops);
+    report_ops("CoefficientCache miss (lookup, not stored)", lookup_misses, ops);
+}
+
+// The original simulation's per-sample generate_emg_signal(t), kept as the reference for
+// EMGGenerator: mt19937 draws for every random term and three sin() calls per sample
+class LegacyEMGSource {
+private:
+    std::mt19937 gen;
+    std::uniform_real_distribution<float> dist, amp_dist, freq_dist, burst_dist, burst_scale;
+    float phase1, phase2;
+    float burst_factor;
+    int burst_duration;
+    std::size_t index;
+
+public:
+    explicit LegacyEMGSource(unsigned seed)
+        : gen(seed), dist(-0.2f, 0.2f), amp_dist(0.8f, 1.2f), freq_dist(0.9f, 1.1f), burst_dist(0.0f, 1.0f),
+          burst_scale(1.0f, 3.0f), phase1(0.0f), phase2(0.0f), burst_factor(1.0f), burst_duration(0), index(0) {}
+
+    float generate(float t) {
+        const float pi = 3.14159265358979f;
+        const float time_step = 1.0f / SAMPLE_RATE;
+        if (index++ % 50 == 0) {
+            if (burst_dist(gen) < 0.2f) {
+                burst_factor = burst_scale(gen);
+                burst_duration = 100;
+            } else if (burst_duration <= 0) {
+                burst_factor = 1.0f;
+            }
+        }
+        if (burst_duration > 0) {
+            burst_duration--;
+        }
+
+        float amp1 = 0.5f * amp_dist(gen);
+        float amp2 = 0.3f * amp_dist(gen);
+        float freq1 = 20.0f * freq_dist(gen);
+        float freq2 = 30.0f * freq_dist(gen);
+        phase1 += 2.0f * pi * freq1 * time_step;
+        phase2 += 2.0f * pi * freq2 * time_step;
+
+        float emg = burst_factor * (amp1 * std::sin(phase1) + amp2 * std::sin(phase2));
+        emg += 0.3f * std::sin(2.0f * pi * 10.0f * t);
+        emg += dist(gen);
+        return emg;
+    }
+};
+
+// Synthetic EMG: the original per-sample generator against EMGGenerator on one channel and
+// across the 64-channel array
+void bench_generator() {
+    std::vector<float> legacy_out(BENCH_SAMPLES);
+    LegacyEMGSource legacy(1234);
+    double per_sample = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+            legacy_out[i] = legacy.generate(i / SAMPLE_RATE);
+        }
+    });
+
+    std::vector<float> single_out(BENCH_SAMPLES);
+    EMGGenerator single(1, SAMPLE_RATE, 1234);
+    double batched = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; i += BLOCK_SIZE) {
+            single.generate(single_out.data() + i, std::min(BLOCK_SIZE, BENCH_SAMPLES - i));
+        }
+    });
+
+    const std::size_t frames = BENCH_SAMPLES / BANK_CHANNELS;
+    std::vector<float> bank_out(BLOCK_SIZE * BANK_CHANNELS);
+    EMGGenerator bank(BANK_CHANNELS, SAMPLE_RATE, 1234);
+    double banked = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            bank.generate(bank_out.data(), std::min(BLOCK_SIZE, frames - f));
+        }
+    });
+    sink = legacy_out.back() + single_out.back() + bank_out.back();
+
+    begin_suite("Synthetic EMG generation");
+    report("generate_emg_signal (per sample)", per_sample, BENCH_SAMPLES);
+    report("EMGGenerator, 1 channel", batched, BENCH_SAMPLES);
+    report("EMGGenerator, 64 channels", banked, frames * BANK_CHANNELS);
+    std::cout << "Speedup: " << per_sample / batched << "x (1 channel), " << per_sample / banked
+              << "x per sample (64 channels)" << std::endl;
+
+    // Small banks run narrower loops; their channels must match the same channels of a wide bank
+    EMGGenerator wide(BANK_CHANNELS, SAMPLE_RATE, 1234);
+    std::vector<float> wide_out(BLOCK_SIZE * BANK_CHANNELS);
+    wide.generate(wide_out.data(), BLOCK_SIZE);
+    for (std::size_t channels : { (std::size_t)1, (std::size_t)3 }) {
+        EMGGenerator narrow(channels, SAMPLE_RATE, 1234);
+        std::vector<float> narrow_out(BLOCK_SIZE * channels);
+        narrow.generate(narrow_out.data(), BLOCK_SIZE);
+        bool identical = true;
+        for (std::size_t f = 0; f < BLOCK_SIZE; ++f) {
+            for (std::size_t c = 0; c < channels; ++c) {
+                identical &= narrow_out[f * channels + c] == wide_out[f * BANK_CHANNELS + c];
+            }
+        }
+        std::cout << "  " << channels << "-channel bank identical to the 64-channel bank: " << (identical ? "yes" : "no")
+                  << std::endl;
+    }
+}
+
+// ARRAY_CHANNELS of synthetic EMG generated in BLOCK_SIZE blocks on one thread, then in larger
+// blocks on 1, 4 and 16 workers, and the second half again from a seek(): every run must
+// match the reference bit for bit. Then the cost of seeking back within a long session.
+void bench_generator_threads() {
+    const std::size_t frames = BENCH_SAMPLES / ARRAY_CHANNELS;
+    const std::size_t pool_block = 8 * BLOCK_SIZE;
+    const std::size_t bytes = frames * ARRAY_CHANNELS * sizeof(float);
+    std::vector<float> reference(frames * ARRAY_CHANNELS), output(frames * ARRAY_CHANNELS);
+
+    EMGGenerator serial(ARRAY_CHANNELS, SAMPLE_RATE, 1234);
+    double single = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += BLOCK_SIZE) {
+            serial.generate(reference.data() + f * ARRAY_CHANNELS, std::min(BLOCK_SIZE, frames - f));
+        }
+    });
+
+    begin_suite(std::to_string(ARRAY_CHANNELS) + "-channel EMGGenerator, reproducibility");
+    report("generate(), 1 thread", single, frames * ARRAY_CHANNELS);
+    const std::size_t worker_counts[] = { 1, 4, 16 };
+    for (std::size_t workers : worker_counts) {
+        ThreadPool pool(workers, false);
+        EMGGenerator parallel(ARRAY_CHANNELS, SAMPLE_RATE, 1234);
+        double elapsed = time_it([&] {
+            for (std::size_t f = 0; f < frames; f += pool_block) {
+                parallel.generate(output.data() + f * ARRAY_CHANNELS, std::min(pool_block, frames - f), pool);
+            }
+        });
+        report(("generate(pool), " + std::to_string(workers) + " workers").c_str(), elapsed, frames * ARRAY_CHANNELS);
+        std::cout << "  bit-identical to the reference: "
+                  << (std::memcmp(reference.data(), output.data(), bytes) == 0 ? "yes" : "NO") << std::endl;
+    }
+
+    // Off the generator's checkpoint schedule, so the seek ends partway into an interval
+    const std::size_t half = frames / 2 + 333;
+    const std::size_t tail_bytes = (frames - half) * ARRAY_CHANNELS * sizeof(float);
+    EMGGenerator resumed(ARRAY_CHANNELS, SAMPLE_RATE, 1234);
+    double seeking = time_it([&] { resumed.seek(half); });
+    resumed.generate(output.data(), frames - half);
+    report("seek() over the first half", seeking, half * ARRAY_CHANNELS);
+    std::cout << "  second half after seek() bit-identical: "
+              << (std::memcmp(reference.data() + half * ARRAY_CHANNELS, output.data(), tail_bytes) == 0 ? "yes" : "NO")
+              << std::endl;
+    // Seeking back in a long session replays from the last checkpoint, however far in it is
+    const std::uint64_t session_frames = (std::uint64_t)(600 * SAMPLE_RATE); // 10 minutes
+    EMGGenerator long_session(SCHEDULER_CHUNK_CHANNELS, SAMPLE_RATE, 1234);
+    double first_seek = time_it([&] { long_session.seek(session_frames); });
+    double back_seek = time_it([&] { long_session.seek(session_frames - (std::uint64_t)SAMPLE_RATE); });
+    std::cout << "seek() to 10 minutes in, " << SCHEDULER_CHUNK_CHANNELS << " channels: " << first_seek * 1e3
+              << " ms the first time, " << back_seek * 1e3 << " ms back 1 s from a checkpoint ("
+              << long_session.checkpoint_bytes() << " bytes of checkpoints)" << std::endl;
+    sink = output.back();
+}
+
+// Full-wave rectification, one call per sample against the block call
+void bench_rectify() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(2468);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    std::vector<float> per_out(BENCH_SAMPLES), block_out(BENCH_SAMPLES);
+    double per_sample = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+            per_out[i] = rectify(input[i]);
+        }
+    });
+    double block = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; i += BLOCK_SIZE) {
+            rectify(input.data() + i, block_out.data() + i, std::min(BLOCK_SIZE, BENCH_SAMPLES - i));
+        }
+    });
+    sink = per_out.back() + block_out.back();
+
+    begin_suite("Rectify");
+    report("Per-sample rectify(float)", per_sample, BENCH_SAMPLES);
+    report("Block rectify(in, out, n)", block, BENCH_SAMPLES);
+}
+
+// Sliding-max updates behind the plots' autoscale: one RunningMax per plotted signal over the
+// 1000-sample display window
+void bench_running_max() {
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(1357);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    RunningMax random_max(1000), falling_max(1000);
+    double random = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+            random_max.push(input[i]);
+        }
+    });
+    // A falling ramp never evicts from the back, so the deque stays full: the worst case
+    double falling = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+            falling_max.push(-(float)i);
+        }
+    });
+    sink = random_max.max() + falling_max.max();
+
+    begin_suite("RunningMax over a 1000-sample window");
+    report("push, random input", random, BENCH_SAMPLES);
+    report("push, falling ramp", falling, BENCH_SAMPLES);
+}
+
+// Streaming samples through a 1024-sample ring and reading the latest window oldest first after
+// every hop, as the spectral analyzer does: a plain ring split at the wrap against a MirroredRing
+void bench_mirrored_ring() {
+    const std::size_t window = 1024;
+    const std::size_t hop = 100; // Not a divisor of the window, so the wrap moves around
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(8080);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+    std::vector<float> frame(window);
+    float checksum_split = 0.0f, checksum_mirrored = 0.0f;
+
+    std::vector<float> ring(window);
+    std::size_t position = 0;
+    double split = time_it([&] {
+        for (std::size_t i = 0; i + hop <= BENCH_SAMPLES; i += hop) {
+            for (std::size_t k = 0; k < hop; ++k) {
+                ring[position] = input[i + k];
+                position = (position + 1) % window;
+            }
+            const std::size_t tail = window - position;
+            std::memcpy(frame.data(), ring.data() + position, tail * sizeof(float));
+            std::memcpy(frame.data() + tail, ring.data(), position * sizeof(float));
+            checksum_split += frame[0] + frame[window - 1];
+        }
+    });
+
+    MirroredRing<float> mirrored(window);
+    double spanned = time_it([&] {
+        for (std::size_t i = 0; i + hop <= BENCH_SAMPLES; i += hop) {
+            mirrored.push(input.data() + i, hop);
+            const float* latest = mirrored.latest(window);
+            checksum_mirrored += latest[0] + latest[window - 1];
+        }
+    });
+    sink = checksum_split + checksum_mirrored + frame[0];
+
+    begin_suite("Ring of 1024 samples, latest window read every 100 samples");
+    report("Ring with % indexing, split copy", split, BENCH_SAMPLES);
+    report(mirrored.is_mapped() ? "MirroredRing (double-mapped), span" : "MirroredRing (copied mirror), span", spanned,
+           BENCH_SAMPLES);
+    std::cout << "Speedup: " << split / spanned << "x, windows identical: "
+              << (checksum_split == checksum_mirrored ? "yes" : "no") << std::endl;
+}
+
+// A 30 s display window decimated to 800 columns: MinMaxPyramid pushes, and one frame's
+// decimation against a scan of every sample in the window
+void bench_display_lod() {
+    const std::size_t window = 60000; // 30 s at 2000 Hz
+    const std::size_t columns = 800;
+    std::vector<float> input(BENCH_SAMPLES);
+    std::mt19937 gen(1470);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    for (float& x : input) {
+        x = dist(gen);
+    }
+
+    MinMaxPyramid pyramid(window);
+    double pushed = time_it([&] {
+        for (std::size_t i = 0; i < BENCH_SAMPLES; ++i) {
+            pyramid.push(input[i]);
+        }
+    });
+
+    const std::size_t frames = 1000;
+    std::vector<float> decimated(2 * columns), scanned(2 * columns);
+    double lod = time_it([&] {
+        for (std::size_t f = 0; f < frames; ++f) {
+            pyramid.decimate(window, columns, decimated.data());
+        }
+    });
+
+    // The same columns from the newest window of raw samples
+    const float* newest = input.data() + BENCH_SAMPLES - window;
+    double scan = time_it([&] {
+        for (std::size_t f = 0; f < frames; ++f) {
+            for (std::size_t c = 0; c < columns; ++c) {
+                std::size_t first = c * window / columns, last = (c + 1) * window / columns;
+                float low = newest[first], high = newest[first];
+                for (std::size_t i = first + 1; i < last; ++i) {
+                    low = std::min(low, newest[i]);
+                    high = std::max(high, newest[i]);
+                }
+                scanned[2 * c] = low;
+                scanned[2 * c + 1] = high;
+            }
+        }
+    });
+
+    float max_diff = 0.0f;
+    for (std::size_t i = 0; i < 2 * columns; ++i) {
+        max_diff = std::max(max_diff, std::abs(decimated[i] - scanned[i]));
+    }
+    sink = decimated[0] + scanned[0];
+
+    begin_suite("30 s display window at 800 columns");
+    report("MinMaxPyramid push", pushed, BENCH_SAMPLES);
+    report_ops("MinMaxPyramid decimate (per frame)", lod, frames);
+    report_ops("Scan of every sample (per frame)", scan, frames);
+    std::cout << "Speedup: " << scan / lod << "x, max column difference: " << max_diff << std::endl;
+}
+
+// Onset events as a bench chain fires them
+static void log_event(void* context, const MuscleEvent& event) {
+    static_cast<std::vector<MuscleEvent>*>(context)->push_back(event);
+}
+
+// The same events in the same order, ignoring when each fired
+static bool same_events(const std::vector<MuscleEvent>& a, const std::vector<MuscleEvent>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].frame != b[i].frame || a[i].detected != b[i].detected || a[i].channel != b[i].channel ||
+            a[i].type != b[i].type || a[i].level != b[i].level) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void bench_parallel_channels() {
+    const std::size_t block = 64; // The viewer's ACQUISITION_BLOCK_SIZE
+    const std::size_t frames = BENCH_SAMPLES / ARRAY_CHANNELS;
+    std::vector<float> input(frames * ARRAY_CHANNELS);
+    EMGGenerator generator(ARRAY_CHANNELS, SAMPLE_RATE, 9012);
+    generator.generate(input.data(), frames);
+
+    // The viewer's whole chain, with every optional stage on
+    SessionConfig config;
+    config.sample_rate = SAMPLE_RATE;
+    config.channels = ARRAY_CHANNELS;
+    config.mains_frequency = 10.0f; // The generator's power line
+    config.envelope_rate = 100.0f;
+    config.onset_threshold = 0.0006f;
+    config.onset_tkeo = true;
+    const std::size_t last = (frames - 1) / block * block; // First frame of the last block
+    const std::size_t last_floats = (frames - last) * ARRAY_CHANNELS;
+
+    // Single-threaded reference: one ChainBank across the whole array
+    ArenaSizer reference_sizer;
+    ChainBank::carve(reference_sizer, config, block);
+    Arena reference_arena(reference_sizer.bytes());
+    ChainBank reference(config, block, ChainBank::carve(reference_arena, config, block));
+    std::vector<MuscleEvent> reference_events;
+    reference.set_event_callback(log_event, &reference_events);
+    double single = time_it([&] {
+        for (std::size_t f = 0; f < frames; f += block) {
+            reference.process(input.data() + f * ARRAY_CHANNELS, std::min(block, frames - f));
+        }
+    });
+
+    begin_suite(std::to_string(ARRAY_CHANNELS) + "-channel viewer chain, ChannelScheduler (" +
+                std::to_string(SCHEDULER_CHUNK_CHANNELS) + "-channel ChainBank chunks)");
+    report("Single-threaded ChainBank", single, input.size());
+
+    std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t workers = 1; workers <= cores; workers *= 2) {
+        ThreadPool pool(workers);
+        ArenaSizer sizer;
+        ChannelScheduler::carve(sizer, config, block, workers);
+        Arena arena(sizer.bytes());
+        ChannelScheduler scheduler(config, block, ChannelScheduler::carve(arena, config, block, workers), &pool);
+        std::vector<MuscleEvent> events;
+        scheduler.set_event_callback(log_event, &events);
+        double parallel = time_it([&] {
+            for (std::size_t f = 0; f < frames; f += block) {
+                scheduler.process(input.data() + f * ARRAY_CHANNELS, std::min(block, frames - f));
+            }
+        });
+
+        // Any difference in a chunk's state would still show in the last block's outputs
+        bool identical = same_events(reference_events, events) &&
+                         scheduler.decimated_frames() == reference.decimated_frames() &&
+                         std::memcmp(scheduler.decimated_envelope(), reference.decimated_envelope(),
+                                     reference.decimated_frames() * ARRAY_CHANNELS * sizeof(float)) == 0;
+        for (std::size_t t = 1; t < ChainBank::TAPS; ++t) {
+            identical = identical && std::memcmp(scheduler.tap(t), reference.tap(t), last_floats * sizeof(float)) == 0;
+        }
+        sink = scheduler.tap(ChainBank::TAPS - 1)[0];
+
+        std::string name = std::to_string(workers) + (workers == 1 ? " worker" : " workers");
+        report(name.c_str(), parallel, input.size());
+        std::cout << "  speedup over single-threaded: " << single / parallel << "x, parallel efficiency: "
+                  << single / parallel / workers * 100.0 << "%, " << events.size()
+                  << " onset events; identical to one ChainBank: " << (identical ? "yes" : "NO") << std::endl;
+    }
+}
+
+// Write every recorded result as JSON
+bool write_json(const char* path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out << "{\n  \"isa\": \"" << simd::ISA_NAME << "\",\n  \"bench_samples\": " << BENCH_SAMPLES
+        << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    { \"suite\": \"" << r.suite << "\", \"name\": \"" << r.name << "\", \"unit\": \"" << r.unit
+            << "\", \"ns_per_item\": " << r.ns_per_item << ", \"items_per_second\": " << r.items_per_second << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+struct Suite {
+    const char* id;
+    void (*run)();
+};
+
+const Suite SUITES[] = {
+    { "filter", bench_filter_block_vs_per_sample },
+    { "filter-forms", bench_filter_forms },
+    { "filter-design", bench_filter_design },
+    { "pipeline", bench_pipeline },
+    { "filter-bank", bench_filter_bank },
+    { "chain-bank", bench_chain_bank },
+    { "latency", bench_latency },
+    { "generator", bench_generator },
+    { "generator-threads", bench_generator_threads },
+    { "rectify", bench_rectify },
+    { "running-max", bench_running_max },
+    { "mirrored-ring", bench_mirrored_ring },
+    { "display-lod", bench_display_lod },
+    { "envelopes", bench_envelopes },
+    { "spectral", bench_spectral_analysis },
+    { "sos-cascade", bench_sos_cascade },
+    { "power-line", bench_power_line },
+    { "decimator", bench_decimator },
+    { "onset", bench_onset },
+    { "parallel-channels", bench_parallel_channels },
+};
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* json_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--list") == 0) {
+            for (const Suite& suite : SUITES) {
+                std::cout << suite.id << std::endl;
+            }
+            return 0;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--list] [--filter <text>] [--json <file>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Running benchmarks over " << BENCH_SAMPLES << " samples each" << std::endl;
+    for (const Suite& suite : SUITES) {
+        if (filter && !std::strstr(suite.id, filter)) {
+            continue;
+        }
+        current_suite = suite.id;
+        suite.run();
+    }
+
+    if (json_path) {
+        if (!write_json(json_path)) {
+            std::cerr << "Failed to write " << json_path << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << results.size() << " results to " << json_path << std::endl;
+    }
+    return 0;
+}
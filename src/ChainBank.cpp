@@ -0,0 +1,82 @@
+#include "ChainBank.h"
+#include <cmath>
+#include <new>
+
+std::size_t ChainBank::moving_window(const SessionConfig& config) {
+    return config.envelope == EnvelopeType::LowPass ? 1
+                                                     : envelope_window_samples(config.sample_rate, config.envelope_window);
+}
+
+ChainBank::ChainBank(const SessionConfig& config, std::size_t block_frames, const Storage& storage)
+    : count(config.channels), stage_floats(block_frames * config.channels), envelope(config.envelope),
+      highpass(config.channels, design_biquad(FilterType::HighPass, config.sample_rate, config.highpass_cutoff),
+               storage.highpass),
+      bandpass(config.channels,
+               design_biquad(FilterType::BandPass, config.sample_rate, config.bandpass_low, config.bandpass_high),
+               storage.bandpass),
+      lowpass(storage.lowpass),
+      moving(config.channels, config.envelope, moving_window(config), storage.moving),
+      cancel_mains(config.mains_frequency > 0.0f), cancelled(storage.cancelled), decimate(config.envelope_rate > 0.0f),
+      decimated(storage.decimated), decimated_count(0), detect_onsets(config.onset_threshold > 0.0f), stages(storage.stages), input(storage.stages), timers(nullptr) {
+    const PreciseFilter prototype(FilterType::LowPass, config.sample_rate, config.lowpass_cutoff);
+    for (std::size_t ch = 0; ch < count; ++ch) {
+        new (lowpass + ch) PreciseFilter(prototype);
+    }
+    if (cancel_mains) {
+        mains = PowerLineCanceller(count, config.sample_rate, config.mains_frequency, config.mains_harmonics,
+                                   config.mains_step, storage.mains);
+    }
+    if (decimate) {
+        decimator = PolyphaseDecimator(count, config.sample_rate, config.envelope_rate, block_frames, storage.decimator);
+    }
+    if (detect_onsets) {
+        OnsetSettings settings;
+        settings.onset_threshold = config.onset_threshold;
+        settings.offset_threshold = config.offset_threshold > 0.0f ? config.offset_threshold : config.onset_threshold / 2.0f;
+        settings.hold_frames = (std::size_t)std::lround(config.onset_hold * config.sample_rate);
+        settings.tkeo = config.onset_tkeo;
+        onsets = OnsetDetector(count, config.sample_rate, settings, storage.onsets);
+    }
+}
+
+void ChainBank::process(const float* in, std::size_t frames) {
+    float* highpassed = stages;
+    float* bandpassed = stages + stage_floats;
+    float* rectified = stages + 2 * stage_floats;
+    float* enveloped = stages + 3 * stage_floats;
+    input = in;
+
+    std::int64_t start = timers ? latency_now() : 0;
+    const float* filter_input = in;
+    if (cancel_mains) {
+        mains.process(in, cancelled, frames, count);
+        filter_input = cancelled;
+        lap(0, start);
+    }
+    highpass.process(filter_input, highpassed, frames, count);
+    lap(1, start);
+    bandpass.process(highpassed, bandpassed, frames, count);
+    lap(2, start);
+    rectify(bandpassed, rectified, frames * count);
+    lap(3, start);
+    if (envelope == EnvelopeType::LowPass) {
+        // Channels side by side, so each frame touches every filter's state once
+        for (std::size_t f = 0; f < frames; ++f) {
+            const float* src = rectified + f * count;
+            float* dst = enveloped + f * count;
+            for (std::size_t ch = 0; ch < count; ++ch) {
+                dst[ch] = lowpass[ch].process(src[ch]);
+            }
+        }
+    } else {
+        moving.process(bandpassed, enveloped, frames, count);
+    }
+    if (decimate) {
+        decimated_count = decimator.process(enveloped, frames, decimated);
+    }
+    lap(4, start);
+    if (detect_onsets) {
+        onsets.process(onsets.uses_tkeo() ? bandpassed : enveloped, frames, count);
+        lap(5, start);
+    }
+}
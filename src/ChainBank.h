@@ -0,0 +1,142 @@
+#ifndef CHAIN_BANK_H
+#define CHAIN_BANK_H
+
+#include <cstddef>
+#include "Envelope.h"
+#include "Filter.h"
+#include "FilterBank.h"
+#include "Latency.h"
+#include "OnsetDetector.h"
+#include "PolyphaseDecimator.h"
+#include "PowerLineCanceller.h"
+#include "Session.h"
+
+// The simulation's chain (high-pass -> band-pass -> rectify -> envelope) over every channel of a
+// session at once, on interleaved [frame][channel] blocks. The filters are FilterBankViews and
+// the moving envelopes a MovingEnvelopeBank, so each stage runs across channels with SIMD; the
+// low-pass envelope is one PreciseFilter per channel, side by side. Every channel produces
+// exactly what its own Filter/EnvelopeDetector chain would. If the session sets a mains
+// frequency, a PowerLineCanceller runs ahead of the high-pass (its output isn't a tap), and if it
+// sets an envelope rate a PolyphaseDecimator brings each block's envelope down to that rate.
+// With an onset threshold, an OnsetDetector watches the envelope (or the band-passed signal's
+// TKEO) and reports muscle onsets and offsets through a callback as each block is processed.
+// All state lives in storage the caller carves out up front (see carve()), so processing never
+// allocates. Each stage's output for the last block stays readable as a tap.
+class ChainBank {
+public:
+    static constexpr std::size_t TAPS = 5; // Input, high-passed, band-passed, rectified, envelope
+    static constexpr std::size_t TIMED_STAGES = 6; // Power-line canceller, one per tap after the input, onsets
+
+    // Where a ChainBank's state lives
+    struct Storage {
+        float* highpass; // FilterBankView lanes
+        float* bandpass;
+        PreciseFilter* lowpass; // One per channel, for the LowPass envelope
+        float* moving; // MovingEnvelopeBank storage
+        float* mains; // PowerLineCanceller storage, and its output for one block
+        float* cancelled;
+        float* decimator; // PolyphaseDecimator storage, and its output for one block
+        float* decimated;
+        OnsetDetector::ChannelState* onsets;
+        float* stages; // TAPS - 1 blocks of block_frames * channels floats
+    };
+
+    // Carve the storage for a session's chain out of an Arena (or measure it with an ArenaSizer)
+    template <typename Allocator>
+    static Storage carve(Allocator& arena, const SessionConfig& config, std::size_t block_frames) {
+        Storage storage;
+        storage.highpass = arena.template allocate<float>(FilterBankView::storage_floats(config.channels));
+        storage.bandpass = arena.template allocate<float>(FilterBankView::storage_floats(config.channels));
+        storage.lowpass = arena.template allocate<PreciseFilter>(config.channels);
+        storage.moving = arena.template allocate<float>(
+            MovingEnvelopeBank::storage_floats(config.channels, moving_window(config)));
+        const bool cancel_mains = config.mains_frequency > 0.0f;
+        storage.mains = arena.template allocate<float>(
+            cancel_mains ? PowerLineCanceller::storage_floats(config.channels, config.mains_harmonics) : 0);
+        storage.cancelled = arena.template allocate<float>(cancel_mains ? block_frames * config.channels : 0);
+        const bool decimate = config.envelope_rate > 0.0f;
+        storage.decimator = arena.template allocate<float>(
+            decimate ? PolyphaseDecimator::storage_floats(config.channels, config.sample_rate, config.envelope_rate,
+                                                          block_frames)
+                     : 0);
+        storage.decimated = arena.template allocate<float>(
+            decimate ? PolyphaseDecimator::max_output(config.sample_rate, config.envelope_rate, block_frames) *
+                           config.channels
+                     : 0);
+        storage.onsets = arena.template allocate<OnsetDetector::ChannelState>(
+            config.onset_threshold > 0.0f ? config.channels : 0);
+        storage.stages = arena.template allocate<float>((TAPS - 1) * block_frames * config.channels);
+        return storage;
+    }
+
+    // - block_frames: Most frames one process() call takes
+    // - storage: From carve() with the same config and block_frames
+    ChainBank(const SessionConfig& config, std::size_t block_frames, const Storage& storage);
+
+    std::size_t channels() const { return count; }
+
+    // Retune every channel's filters, keeping their state (ramp_samples as for Filter)
+    void set_highpass(const BiquadCoefficients& c, std::size_t ramp_samples) { highpass.set_coefficients(c, ramp_samples); }
+    void set_bandpass(const BiquadCoefficients& c, std::size_t ramp_samples) { bandpass.set_coefficients(c, ramp_samples); }
+
+    // Time each stage of every process() call into TIMED_STAGES consecutive stages (power-line
+    // canceller, high-pass, band-pass, rectify, envelope, onset detector), or stop timing with
+    // nullptr. The canceller and detector are only timed when they run; the envelope includes
+    // its decimation.
+    void set_stage_timers(LatencyStage* stages) { timers = stages; }
+
+    // Where the onset detector's events go (see OnsetDetector::set_callback); they fire during
+    // process(), on its thread
+    bool detects_onsets() const { return detect_onsets; }
+    void set_event_callback(MuscleEventCallback callback, void* context) { onsets.set_callback(callback, context); }
+
+    // Run up to block_frames frames of channels samples each through every stage
+    void process(const float* in, std::size_t frames);
+
+    // Signal at one tap for the last block, [frame][channel]: tap 0 is the input and tap k + 1
+    // the output of stage k, the same order as Pipeline's taps and RecordedStream
+    const float* tap(std::size_t index) const { return index == 0 ? input : stages + (index - 1) * stage_floats; }
+
+    // The last block's envelope at the session's envelope rate, [frame][channel], and how many
+    // frames of it came due (none if the session doesn't decimate)
+    const float* decimated_envelope() const { return decimated; }
+    std::size_t decimated_frames() const { return decimated_count; }
+
+    // How far the decimated envelope lags the envelope tap (input frames)
+    float decimation_delay() const { return decimate ? decimator.delay() : 0.0f; }
+
+private:
+    std::size_t count;
+    std::size_t stage_floats; // Floats per stage output
+    EnvelopeType envelope;
+    FilterBankView highpass;
+    FilterBankView bandpass;
+    PreciseFilter* lowpass;
+    MovingEnvelopeBank moving;
+    bool cancel_mains;
+    PowerLineCanceller mains;
+    float* cancelled;
+    bool decimate;
+    PolyphaseDecimator decimator;
+    float* decimated;
+    std::size_t decimated_count;
+    bool detect_onsets;
+    OnsetDetector onsets;
+    float* stages;
+    const float* input; // Last block's input
+    LatencyStage* timers; // Per-stage timing, if set
+
+    // Record the time since start for a stage and restart the clock
+    void lap(std::size_t stage, std::int64_t& start) {
+        if (timers) {
+            std::int64_t now = latency_now();
+            timers[stage].histogram.record(now - start);
+            start = now;
+        }
+    }
+
+    // Moving window length for a config (one sample when the envelope is the low-pass)
+    static std::size_t moving_window(const SessionConfig& config);
+};
+
+#endif // CHAIN_BANK_H
@@ -0,0 +1,128 @@
+#include "ChannelScheduler.h"
+#include <cstring>
+
+ChannelScheduler::ChannelScheduler(const SessionConfig& config, std::size_t block_frames, const Storage& storage,
+                                   ThreadPool* pool)
+    : pool(pool), count(config.channels), stage_floats(block_frames * config.channels),
+      split(chunk_count(config.channels) > 1), stages(storage.stages), decimated(storage.decimated), input(nullptr),
+      event_callback(nullptr), event_context(nullptr) {
+    const std::size_t chunks = chunk_count(config.channels);
+    const std::size_t workers = pool ? pool->size() : 1;
+    slices.resize(chunks);
+    home.resize(chunks);
+    for (std::size_t i = 0; i < chunks; ++i) {
+        const SessionConfig slice_settings = slice_config(config, i);
+        const SliceStorage& s = storage.slices[i];
+        Slice& slice = slices[i];
+        slice.chain.reset(new ChainBank(slice_settings, block_frames, s.chain));
+        slice.first = i * SCHEDULER_CHUNK_CHANNELS;
+        slice.channels = slice_settings.channels;
+        slice.input = s.input;
+        slice.events = s.events;
+        slice.event_count = 0;
+        slice.delivered = 0;
+        home[i] = home_worker(i, chunks, workers);
+    }
+}
+
+void ChannelScheduler::set_highpass(const BiquadCoefficients& c, std::size_t ramp_samples) {
+    for (Slice& slice : slices) {
+        slice.chain->set_highpass(c, ramp_samples);
+    }
+}
+
+void ChannelScheduler::set_bandpass(const BiquadCoefficients& c, std::size_t ramp_samples) {
+    for (Slice& slice : slices) {
+        slice.chain->set_bandpass(c, ramp_samples);
+    }
+}
+
+void ChannelScheduler::set_event_callback(MuscleEventCallback callback, void* context) {
+    event_callback = callback;
+    event_context = context;
+    if (!split) {
+        // One chunk fires on the calling thread already, numbered from channel 0
+        slices[0].chain->set_event_callback(callback, context);
+        return;
+    }
+    for (Slice& slice : slices) {
+        slice.chain->set_event_callback(callback ? buffer_event : nullptr, &slice);
+    }
+}
+
+void ChannelScheduler::buffer_event(void* context, const MuscleEvent& event) {
+    // Room for one event per channel per frame, as many as the detector can fire
+    Slice& slice = *static_cast<Slice*>(context);
+    MuscleEvent& buffered = slice.events[slice.event_count++];
+    buffered = event;
+    buffered.channel += (std::uint32_t)slice.first;
+}
+
+const float* ChannelScheduler::tap(std::size_t index) const {
+    if (index == 0) {
+        return input;
+    }
+    return split ? stages + (index - 1) * stage_floats : slices[0].chain->tap(index);
+}
+
+void ChannelScheduler::process_slice(Slice& slice, const float* in, std::size_t frames) {
+    const std::size_t n = slice.channels;
+    for (std::size_t f = 0; f < frames; ++f) {
+        std::memcpy(slice.input + f * n, in + f * count + slice.first, n * sizeof(float));
+    }
+    slice.event_count = 0;
+    slice.delivered = 0;
+    slice.chain->process(slice.input, frames);
+
+    for (std::size_t t = 1; t < ChainBank::TAPS; ++t) {
+        const float* src = slice.chain->tap(t);
+        float* dst = stages + (t - 1) * stage_floats + slice.first;
+        for (std::size_t f = 0; f < frames; ++f) {
+            std::memcpy(dst + f * count, src + f * n, n * sizeof(float));
+        }
+    }
+    if (decimated) {
+        const float* src = slice.chain->decimated_envelope();
+        for (std::size_t f = 0; f < slice.chain->decimated_frames(); ++f) {
+            std::memcpy(decimated + f * count + slice.first, src + f * n, n * sizeof(float));
+        }
+    }
+}
+
+void ChannelScheduler::deliver_events() {
+    // Each chunk's events are in firing order, frame by frame and channel by channel within it;
+    // merging on the firing frame (lower chunks first on a tie) restores one ChainBank's order
+    for (;;) {
+        Slice* next = nullptr;
+        for (Slice& slice : slices) {
+            if (slice.delivered < slice.event_count &&
+                (!next || slice.events[slice.delivered].detected < next->events[next->delivered].detected)) {
+                next = &slice;
+            }
+        }
+        if (!next) {
+            return;
+        }
+        event_callback(event_context, next->events[next->delivered++]);
+    }
+}
+
+void ChannelScheduler::process(const float* in, std::size_t frames) {
+    input = in;
+    if (!split) {
+        slices[0].chain->process(in, frames);
+        return;
+    }
+    if (pool) {
+        pool->parallel_for(slices.size(), [&](std::size_t index) {
+            process_slice(slices[index], in, frames);
+        }, home.data());
+    } else {
+        for (Slice& slice : slices) {
+            process_slice(slice, in, frames);
+        }
+    }
+    if (event_callback) {
+        deliver_events();
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef CHANNEL_SCHEDULER_H
+#define CHANNEL_SCHEDULER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "ChainBank.h"
+#include "Session.h"
+#include "ThreadPool.h"
+
+// Channels per task: one 64-byte cache line of floats per frame, and a multiple of every SIMD width
+const std::size_t SCHEDULER_CHUNK_CHANNELS = 16;
+
+// A session's ChainBank over many channels in parallel, with ChainBank's interface. Channels are
+// split into chunks of SCHEDULER_CHUNK_CHANNELS, each its own ChainBank slice, so every chunk
+// runs exactly the session's chain (canceller, filters, envelope, decimator, onset detector) and
+// comes out the same as one ChainBank over all the channels. Each worker's chunks are a
+// contiguous channel range with their state in their own region of the arena, kept apart from
+// the others' (Arena::separate()); idle workers steal chunks to absorb imbalance.
+// Per block, each chunk gathers its columns of the input, runs its slice and scatters its taps
+// back, so taps and the decimated envelope are [frame][channel] over the whole bank. A bank of
+// one chunk (or without a pool) runs on the calling thread, and one chunk skips the copies.
+// Onset events are buffered per chunk while the workers run and delivered on the calling thread
+// once process() is done, in the order one ChainBank would fire them.
+class ChannelScheduler {
+public:
+    // Where a chunk's state lives
+    struct SliceStorage {
+        ChainBank::Storage chain;
+        float* input; // Its columns of one block (banks of more than one chunk)
+        MuscleEvent* events; // Events of one block, at most one per channel per frame
+    };
+
+    struct Storage {
+        SliceStorage* slices; // One per chunk
+        float* stages; // ChainBank::TAPS - 1 blocks of block_frames * channels floats (more than one chunk)
+        float* decimated; // Decimated envelope of one block, [frame][channel] (more than one chunk)
+    };
+
+    static std::size_t chunk_count(std::size_t channels) {
+        return (channels + SCHEDULER_CHUNK_CHANNELS - 1) / SCHEDULER_CHUNK_CHANNELS;
+    }
+
+    // Worker that runs a chunk: contiguous ranges, as even as the chunk count allows
+    static std::size_t home_worker(std::size_t chunk, std::size_t chunks, std::size_t workers) {
+        return chunk * workers / chunks;
+    }
+
+    // The session config a chunk's slice runs: the session's, on that chunk's channels
+    static SessionConfig slice_config(const SessionConfig& config, std::size_t chunk) {
+        SessionConfig slice = config;
+        slice.channels = std::min(SCHEDULER_CHUNK_CHANNELS, config.channels - chunk * SCHEDULER_CHUNK_CHANNELS);
+        slice.display_channel = 0;
+        return slice;
+    }
+
+    // Carve the storage for a session's chain over workers threads out of an Arena (or measure it
+    // with an ArenaSizer): each worker's chunks together, then the shared outputs
+    template <typename Allocator>
+    static Storage carve(Allocator& arena, const SessionConfig& config, std::size_t block_frames, std::size_t workers) {
+        Storage storage;
+        const std::size_t chunks = chunk_count(config.channels);
+        const bool split = chunks > 1;
+        storage.slices = arena.template allocate<SliceStorage>(chunks);
+        for (std::size_t worker = 0; worker < workers; ++worker) {
+            for (std::size_t i = 0; i < chunks; ++i) {
+                if (home_worker(i, chunks, workers) != worker) {
+                    continue;
+                }
+                const SessionConfig slice = slice_config(config, i);
+                SliceStorage s;
+                s.chain = ChainBank::carve(arena, slice, block_frames);
+                s.input = arena.template allocate<float>(split ? block_frames * slice.channels : 0);
+                s.events = arena.template allocate<MuscleEvent>(
+                    split && config.onset_threshold > 0.0f ? block_frames * slice.channels : 0);
+                if (storage.slices) {
+                    storage.slices[i] = s;
+                }
+            }
+            arena.separate();
+        }
+        storage.stages = arena.template allocate<float>(split ? (ChainBank::TAPS - 1) * block_frames * config.channels : 0);
+        const bool decimate = split && config.envelope_rate > 0.0f;
+        storage.decimated = arena.template allocate<float>(
+            decimate ? PolyphaseDecimator::max_output(config.sample_rate, config.envelope_rate, block_frames) *
+                           config.channels
+                     : 0);
+        return storage;
+    }
+
+    // - block_frames: Most frames one process() call takes
+    // - storage: From carve() with the same config and block_frames, and pool's worker count
+    // - pool: Runs the chunks, or nullptr to run them all on the calling thread
+    ChannelScheduler(const SessionConfig& config, std::size_t block_frames, const Storage& storage, ThreadPool* pool);
+
+    std::size_t channels() const { return count; }
+    std::size_t chunk_count() const { return slices.size(); }
+
+    // As ChainBank's, for every chunk
+    void set_highpass(const BiquadCoefficients& c, std::size_t ramp_samples);
+    void set_bandpass(const BiquadCoefficients& c, std::size_t ramp_samples);
+
+    // Time the first chunk's stages (see ChainBank::set_stage_timers), standing in for the rest:
+    // the chunks run at once on different threads, and a histogram takes one writer
+    void set_stage_timers(LatencyStage* stages) { slices[0].chain->set_stage_timers(stages); }
+
+    // Where onset events go; they fire on the thread that calls process(), channel numbers
+    // counting across the whole bank
+    bool detects_onsets() const { return slices[0].chain->detects_onsets(); }
+    void set_event_callback(MuscleEventCallback callback, void* context);
+
+    // Run up to block_frames frames of channels samples each through every chunk's chain;
+    // returns once every chunk is done
+    void process(const float* in, std::size_t frames);
+
+    // As ChainBank's, over the whole bank
+    const float* tap(std::size_t index) const;
+    const float* decimated_envelope() const { return split ? decimated : slices[0].chain->decimated_envelope(); }
+    std::size_t decimated_frames() const { return slices[0].chain->decimated_frames(); }
+    float decimation_delay() const { return slices[0].chain->decimation_delay(); }
+
+private:
+    // One chunk, on its own cache lines since its worker writes event_count
+    struct alignas(64) Slice {
+        std::unique_ptr<ChainBank> chain;
+        std::size_t first; // First channel
+        std::size_t channels;
+        float* input;
+        MuscleEvent* events;
+        std::size_t event_count; // Buffered this block
+        std::size_t delivered; // Of them, handed to the callback
+    };
+
+    ThreadPool* pool;
+    std::size_t count; // Total channels
+    std::size_t stage_floats; // Floats per shared stage output
+    bool split; // More than one chunk: inputs are gathered and outputs scattered
+    std::vector<Slice> slices;
+    std::vector<std::size_t> home; // Worker each chunk is queued on
+    float* stages;
+    float* decimated;
+    const float* input; // Last block's input
+    MuscleEventCallback event_callback;
+    void* event_context;
+
+    void process_slice(Slice& slice, const float* in, std::size_t frames);
+    void deliver_events();
+
+    // A slice's onset callback: buffer the event, numbered across the bank, for deliver_events()
+    static void buffer_event(void* context, const MuscleEvent& event);
+};
+
+#endif // CHANNEL_SCHEDULER_H
@@ -0,0 +1,71 @@
+#include "CoefficientCache.h"
+#include <cstring>
+#include <cmath>
+
+// Keys compare by value; cutoffs stepped by exactly representable increments
+// (0.5 Hz, 5 Hz) always land on the same float, so exact matching is enough
+bool CoefficientCache::Key::operator==(const Key& other) const {
+    return type == other.type && sample_rate == other.sample_rate && freq1 == other.freq1 &&
+           freq2 == other.freq2 && q == other.q;
+}
+
+std::size_t CoefficientCache::KeyHash::operator()(const Key& key) const {
+    // Combine the bit patterns of each field
+    float fields[4] = { key.sample_rate, key.freq1, key.freq2, key.q };
+    std::uint64_t hash = 1469598103934665603ull ^ (std::uint64_t)key.type;
+    for (float field : fields) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &field, sizeof(bits));
+        hash = (hash ^ bits) * 1099511628211ull;
+    }
+    return (std::size_t)hash;
+}
+
+CoefficientCache::CoefficientCache() : hit_count(0), miss_count(0) {}
+
+BiquadCoefficients CoefficientCache::get(FilterType type, float sample_rate, float freq1, float freq2, float q) {
+    Key key = { type, sample_rate, freq1, freq2, q };
+    auto it = table.find(key);
+    if (it != table.end()) {
+        ++hit_count;
+        return it->second;
+    }
+    ++miss_count;
+    BiquadCoefficients c = design_biquad(type, sample_rate, freq1, freq2, q);
+    table.emplace(key, c);
+    return c;
+}
+
+BiquadCoefficients CoefficientCache::lookup(FilterType type, float sample_rate, float freq1, float freq2, float q) {
+    Key key = { type, sample_rate, freq1, freq2, q };
+    auto it = table.find(key);
+    if (it != table.end()) {
+        ++hit_count;
+        return it->second;
+    }
+    ++miss_count;
+    return design_biquad(type, sample_rate, freq1, freq2, q);
+}
+
+void CoefficientCache::prepopulate_freq1(FilterType type, float sample_rate, float freq1_min, float freq1_max,
+                                         float freq1_step, float freq2, float q) {
+    // Step by index rather than accumulating so every key matches min + k * step exactly
+    int steps = (int)std::floor((freq1_max - freq1_min) / freq1_step + 0.5f);
+    table.reserve(table.size() + steps + 1);
+    for (int k = 0; k <= steps; ++k) {
+        float freq1 = freq1_min + k * freq1_step;
+        Key key = { type, sample_rate, freq1, freq2, q };
+        table.emplace(key, design_biquad(type, sample_rate, freq1, freq2, q));
+    }
+}
+
+void CoefficientCache::prepopulate_freq2(FilterType type, float sample_rate, float freq1, float freq2_min,
+                                         float freq2_max, float freq2_step, float q) {
+    int steps = (int)std::floor((freq2_max - freq2_min) / freq2_step + 0.5f);
+    table.reserve(table.size() + steps + 1);
+    for (int k = 0; k <= steps; ++k) {
+        float freq2 = freq2_min + k * freq2_step;
+        Key key = { type, sample_rate, freq1, freq2, q };
+        table.emplace(key, design_biquad(type, sample_rate, freq1, freq2, q));
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef COEFFICIENT_CACHE_H
+#define COEFFICIENT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include "Filter.h"
+
+// Memoizes normalized biquad coefficients keyed by their design parameters.
+// Cutoffs that only move in fixed steps hit the same keys over and over, so after the
+// first design (or a prepopulate call at startup) retuning is a hash lookup with no trig.
+// get() stores what it designs, which allocates; a real-time thread uses lookup() instead,
+// which never allocates and designs a key that isn't stored on every call.
+// Not synchronized: give each thread its own cache, or fill it before sharing it read-only.
+class CoefficientCache {
+private:
+    struct Key {
+        FilterType type;
+        float sample_rate;
+        float freq1;
+        float freq2;
+        float q;
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    std::unordered_map<Key, BiquadCoefficients, KeyHash> table;
+    std::size_t hit_count;
+    std::size_t miss_count;
+
+public:
+    CoefficientCache();
+
+    // Return cached coefficients, designing and storing them on first use
+    BiquadCoefficients get(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f);
+
+    // The same without ever allocating: a key that isn't stored is designed and not stored
+    BiquadCoefficients lookup(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f);
+
+    // Design every freq1 in [freq1_min, freq1_max] at freq1_step with freq2 held fixed
+    // (e.g. the high-pass cutoff range)
+    void prepopulate_freq1(FilterType type, float sample_rate, float freq1_min, float freq1_max, float freq1_step,
+                           float freq2 = 0.0f, float q = 1.0f);
+
+    // Design every freq2 in [freq2_min, freq2_max] at freq2_step with freq1 held fixed
+    // (e.g. the band-pass upper edge range)
+    void prepopulate_freq2(FilterType type, float sample_rate, float freq1, float freq2_min, float freq2_max,
+                           float freq2_step, float q = 1.0f);
+
+    std::size_t size() const { return table.size(); }
+    std::size_t hits() const { return hit_count; }
+    std::size_t misses() const { return miss_count; }
+};
+
+#endif // COEFFICIENT_CACHE_H
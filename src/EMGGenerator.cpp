@@ -0,0 +1,261 @@
+#include "EMGGenerator.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <algorithm>
+
+#define PI 3.14159265358979323846
+
+const std::uint64_t BURST_CHECK_INTERVAL = 50; // Frames between burst decisions
+const float BURST_PROBABILITY = 0.2f; // Chance of a burst at each decision
+const int BURST_LENGTH = 100; // Burst duration (samples)
+const std::uint64_t RENORMALIZE_INTERVAL = 256; // Frames between phasor renormalizations
+const std::uint64_t CHECKPOINT_INTERVAL = 16384; // Frames between checkpoints of the state (~8 s at 2 kHz)
+const std::size_t CHECKPOINT_CHANNEL_FLOATS = 6; // re1, im1, re2, im2, burst factor, burst duration
+const std::size_t GENERATOR_LANES = 16; // Channels generated together in one vectorized loop
+const std::size_t NARROW_LANES = 4; // Width for a short last chunk (or a bank of only a few channels)
+
+// What a Philox draw is for, in the last counter word; the frame and channel fill the others
+const std::uint32_t SAMPLE_DRAWS = 0; // Amplitudes, frequency jitter and noise, every frame
+const std::uint32_t BURST_DRAWS = 1; // Burst decision and scale, on the burst schedule
+
+// Pull n phasors back onto the unit circle
+static void renormalize(float* re, float* im, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        float r = 1.0f / std::sqrt(re[i] * re[i] + im[i] * im[i]);
+        re[i] *= r;
+        im[i] *= r;
+    }
+}
+
+EMGGenerator::EMGGenerator(std::size_t channels, float sample_rate, std::uint64_t seed, const EMGSignalParams& params)
+    : count(channels), sample_rate(sample_rate), params(params), key(philox_key(seed)),
+      re1(channels, 1.0f), im1(channels, 0.0f), re2(channels, 1.0f), im2(channels, 0.0f),
+      burst_factor(channels, 1.0f), burst_duration(channels, 0), sample_count(0),
+      checkpoint_floats(2 + CHECKPOINT_CHANNEL_FLOATS * channels) {
+    delta1 = 2.0f * PI * params.emg_freq / sample_rate;
+    delta2 = 2.0f * PI * (params.emg_freq * 1.5f) / sample_rate;
+    cos1 = std::cos(delta1);
+    sin1 = std::sin(delta1);
+    cos2 = std::cos(delta2);
+    sin2 = std::sin(delta2);
+
+    float line_delta = 2.0f * PI * params.power_line_freq / sample_rate;
+    line_re = 1.0f;
+    line_im = 0.0f;
+    line_cos = std::cos(line_delta);
+    line_sin = std::sin(line_delta);
+    save_checkpoint();
+}
+
+void EMGGenerator::generate_chunk(float* out, std::size_t frames, std::size_t base, float* line_end) {
+    // The narrowest loop that covers the chunk's channels, so one channel doesn't pay for 16.
+    // Lanes never interact, so every width gives the same values.
+    std::size_t lanes = std::min(GENERATOR_LANES, count - base);
+    if (lanes == 1) {
+        generate_lanes<1>(out, frames, base, line_end);
+    } else if (lanes <= NARROW_LANES) {
+        generate_lanes<NARROW_LANES>(out, frames, base, line_end);
+    } else {
+        generate_lanes<GENERATOR_LANES>(out, frames, base, line_end);
+    }
+}
+
+template <std::size_t LANES>
+void EMGGenerator::generate_lanes(float* out, std::size_t frames, std::size_t base, float* line_end) {
+    // Members copied to locals so the compiler can keep them in registers
+    const std::size_t n = count;
+    const std::size_t lanes = std::min(LANES, n - base);
+    const PhiloxKey k = key;
+    const float noise_amplitude = params.noise_amplitude;
+    const float line_amplitude = params.power_line_amplitude;
+    const float d1 = delta1, c1 = cos1, sn1 = sin1;
+    const float d2 = delta2, c2 = cos2, sn2 = sin2;
+
+    // The chunk's state is copied into local arrays, which can't alias the output, so the
+    // fixed-length lane loop vectorizes cleanly
+    float p1r[LANES], p1i[LANES], p2r[LANES], p2i[LANES];
+    float burst[LANES];
+    int duration[LANES];
+    float value[LANES];
+    std::uint32_t w0[LANES], w1[LANES], w2[LANES], w3[LANES]; // Draws
+    for (std::size_t l = 0; l < LANES; ++l) {
+        bool used = l < lanes;
+        p1r[l] = used ? re1[base + l] : 1.0f;
+        p1i[l] = used ? im1[base + l] : 0.0f;
+        p2r[l] = used ? re2[base + l] : 1.0f;
+        p2i[l] = used ? im2[base + l] : 0.0f;
+        burst[l] = used ? burst_factor[base + l] : 1.0f;
+        duration[l] = used ? burst_duration[base + l] : 0;
+    }
+
+    // Every chunk replays the same shared power line phasor from the start of the block
+    float lr = line_re, li = line_im;
+    std::uint64_t frame_index = sample_count;
+    float* dst = out ? out + base : nullptr;
+
+    for (std::size_t f = 0; f < frames; ++f) {
+        const std::uint32_t frame_lo = (std::uint32_t)frame_index, frame_hi = (std::uint32_t)(frame_index >> 32);
+
+        // Burst decisions happen on a fixed frame schedule for every channel
+        if (frame_index % BURST_CHECK_INTERVAL == 0) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                PhiloxCounter r = philox4x32({ frame_lo, frame_hi, (std::uint32_t)(base + l), BURST_DRAWS }, k);
+                if (philox_uniform(r.c0) < BURST_PROBABILITY) {
+                    burst[l] = 1.0f + 2.0f * philox_uniform(r.c1); // Scale amplitude by 1x to 3x
+                    duration[l] = BURST_LENGTH;
+                } else if (duration[l] <= 0) {
+                    burst[l] = 1.0f;
+                }
+            }
+        }
+
+        float line = line_amplitude * li;
+
+        for (std::size_t l = 0; l < LANES; ++l) {
+            w0[l] = frame_lo;
+            w1[l] = frame_hi;
+            w2[l] = (std::uint32_t)(base + l);
+            w3[l] = SAMPLE_DRAWS;
+        }
+        philox4x32_lanes(w0, w1, w2, w3, k);
+
+        for (std::size_t l = 0; l < LANES; ++l) {
+            float amp1 = 0.5f * (0.8f + 0.4f * philox_uniform(w0[l])); // 0.4 to 0.6
+            float amp2 = 0.3f * (0.8f + 0.4f * philox_uniform(w1[l])); // 0.24 to 0.36
+            // Frequency variation (0.9x to 1.1x), 16 bits each from one word
+            float jitter1 = 0.2f * ((w2[l] >> 16) * (1.0f / 65536.0f)) - 0.1f;
+            float jitter2 = 0.2f * ((w2[l] & 0xFFFFu) * (1.0f / 65536.0f)) - 0.1f;
+            float noise = noise_amplitude * (2.0f * philox_uniform(w3[l]) - 1.0f);
+
+            // Rotate each phasor by its jittered step; a first-order expansion around the nominal
+            // step is accurate to ~1e-5 for the +/-10% jitter, and renormalization removes the drift
+            float e1 = d1 * jitter1;
+            float e2 = d2 * jitter2;
+            float rc1 = c1 - sn1 * e1, rs1 = sn1 + c1 * e1;
+            float rc2 = c2 - sn2 * e2, rs2 = sn2 + c2 * e2;
+            float r1 = p1r[l] * rc1 - p1i[l] * rs1;
+            float i1 = p1r[l] * rs1 + p1i[l] * rc1;
+            float r2 = p2r[l] * rc2 - p2i[l] * rs2;
+            float i2 = p2r[l] * rs2 + p2i[l] * rc2;
+            p1r[l] = r1;
+            p1i[l] = i1;
+            p2r[l] = r2;
+            p2i[l] = i2;
+
+            value[l] = burst[l] * (amp1 * i1 + amp2 * i2) + line + noise;
+            duration[l] -= duration[l] > 0;
+        }
+        if (dst) {
+            for (std::size_t l = 0; l < lanes; ++l) {
+                dst[l] = value[l];
+            }
+            dst += n;
+        }
+
+        // Advance the shared power line phasor
+        float next_lr = lr * line_cos - li * line_sin;
+        li = lr * line_sin + li * line_cos;
+        lr = next_lr;
+
+        if (++frame_index % RENORMALIZE_INTERVAL == 0) {
+            renormalize(p1r, p1i, LANES);
+            renormalize(p2r, p2i, LANES);
+            renormalize(&lr, &li, 1);
+        }
+    }
+
+    for (std::size_t l = 0; l < lanes; ++l) {
+        re1[base + l] = p1r[l];
+        im1[base + l] = p1i[l];
+        re2[base + l] = p2r[l];
+        im2[base + l] = p2i[l];
+        burst_factor[base + l] = burst[l];
+        burst_duration[base + l] = duration[l];
+    }
+    if (line_end) {
+        line_end[0] = lr;
+        line_end[1] = li;
+    }
+}
+
+void EMGGenerator::save_checkpoint() {
+    const std::size_t start = checkpoints.size();
+    checkpoints.resize(start + checkpoint_floats);
+    float* state = checkpoints.data() + start;
+    state[0] = line_re;
+    state[1] = line_im;
+    for (std::size_t ch = 0; ch < count; ++ch) {
+        float* channel = state + 2 + ch * CHECKPOINT_CHANNEL_FLOATS;
+        channel[0] = re1[ch];
+        channel[1] = im1[ch];
+        channel[2] = re2[ch];
+        channel[3] = im2[ch];
+        channel[4] = burst_factor[ch];
+        channel[5] = (float)burst_duration[ch]; // At most BURST_LENGTH, so exact
+    }
+}
+
+void EMGGenerator::restore_checkpoint(std::size_t index) {
+    const float* state = checkpoints.data() + index * checkpoint_floats;
+    line_re = state[0];
+    line_im = state[1];
+    for (std::size_t ch = 0; ch < count; ++ch) {
+        const float* channel = state + 2 + ch * CHECKPOINT_CHANNEL_FLOATS;
+        re1[ch] = channel[0];
+        im1[ch] = channel[1];
+        re2[ch] = channel[2];
+        im2[ch] = channel[3];
+        burst_factor[ch] = channel[4];
+        burst_duration[ch] = (int)channel[5];
+    }
+    sample_count = index * CHECKPOINT_INTERVAL;
+}
+
+void EMGGenerator::advance(float* out, std::uint64_t frames, ThreadPool* pool) {
+    // Blocks are cut at checkpoint frames. State carries over exactly between pieces, so the
+    // cuts don't change any value.
+    const std::size_t chunks = (count + GENERATOR_LANES - 1) / GENERATOR_LANES;
+    while (frames > 0) {
+        const std::uint64_t to_checkpoint = CHECKPOINT_INTERVAL - sample_count % CHECKPOINT_INTERVAL;
+        const std::size_t n = (std::size_t)std::min(frames, to_checkpoint);
+        // Chunks are fixed by channel index, whichever worker runs them, and touch only their own
+        // channels' state; the shared phasor and frame count move on once they are all done
+        float line_end[2] = { line_re, line_im };
+        if (pool) {
+            pool->parallel_for(chunks, [&](std::size_t chunk) {
+                generate_chunk(out, n, chunk * GENERATOR_LANES, chunk == 0 ? line_end : nullptr);
+            });
+        } else {
+            for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                generate_chunk(out, n, chunk * GENERATOR_LANES, chunk == 0 ? line_end : nullptr);
+            }
+        }
+        line_re = line_end[0];
+        line_im = line_end[1];
+        sample_count += n;
+        frames -= n;
+        if (out) {
+            out += n * count;
+        }
+        if (sample_count % CHECKPOINT_INTERVAL == 0 &&
+            sample_count / CHECKPOINT_INTERVAL == checkpoints.size() / checkpoint_floats) {
+            save_checkpoint();
+        }
+    }
+}
+
+void EMGGenerator::generate(float* out, std::size_t frames) {
+    advance(out, frames, nullptr);
+}
+
+void EMGGenerator::generate(float* out, std::size_t frames, ThreadPool& pool) {
+    advance(out, frames, &pool);
+}
+
+void EMGGenerator::seek(std::uint64_t frame) {
+    // Replay the oscillators from the last checkpoint without writing anything; the draws
+    // themselves need no replay, but the phasors and burst timers integrate them
+    const std::size_t saved = checkpoints.size() / checkpoint_floats;
+    restore_checkpoint((std::size_t)std::min<std::uint64_t>(frame / CHECKPOINT_INTERVAL, saved - 1));
+    advance(nullptr, frame - sample_count, nullptr);
+}
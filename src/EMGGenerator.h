@@ -0,0 +1,95 @@
+#ifndef EMG_GENERATOR_H
+#define EMG_GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Philox.h"
+
+class ThreadPool;
+
+// Shape of the synthetic EMG signal (defaults match the original simulation)
+struct EMGSignalParams {
+    float emg_freq = 20.0f; // Base EMG frequency (Hz); a second component runs at 1.5x
+    float noise_amplitude = 0.2f; // Amplitude of uniform random noise
+    float power_line_freq = 10.0f; // Power line interference frequency (Hz)
+    float power_line_amplitude = 0.3f; // Amplitude of power line interference
+};
+
+// Block-based synthetic EMG source for any number of independent channels.
+// Every random term is a Philox draw keyed by the seed and counted by (frame, channel), so a
+// channel's signal depends only on the seed, its index and the frame number: not on the
+// block sizes, on which other channels are generated, or on how many threads share the
+// work. The only history is each channel's two oscillators and burst timer, which the
+// generator checkpoints as it goes so seek() only replays from the nearest checkpoint.
+// Per-channel state is stored as structure-of-arrays so the inner loop runs across channels
+// and vectorizes. Oscillators are rotating phasors (one complex multiply per sample)
+// rather than sin() calls, renormalized on a fixed frame schedule.
+class EMGGenerator {
+private:
+    std::size_t count; // Number of channels
+    float sample_rate;
+    EMGSignalParams params;
+    PhiloxKey key;
+
+    // EMG component phasors (re, im) per channel
+    std::vector<float> re1, im1, re2, im2;
+
+    // Nominal per-sample rotation of each component
+    float cos1, sin1, delta1;
+    float cos2, sin2, delta2;
+
+    // Power line phasor, shared by every channel
+    float line_re, line_im, line_cos, line_sin;
+
+    // Burst state per channel
+    std::vector<float> burst_factor;
+    std::vector<int> burst_duration;
+    std::uint64_t sample_count; // Frames generated so far (drives burst scheduling)
+
+    // State at every multiple of CHECKPOINT_INTERVAL frames reached so far: the power line
+    // phasor, then re1, im1, re2, im2, burst factor and burst duration per channel
+    std::vector<float> checkpoints;
+    std::size_t checkpoint_floats; // Per checkpoint
+
+    // Advance the channels of one GENERATOR_LANES chunk by frames, writing them to out
+    // unless it is null; the chunk holding channel 0 also reports where the shared power
+    // line phasor ends up
+    void generate_chunk(float* out, std::size_t frames, std::size_t base, float* line_end);
+
+    // generate_chunk() for a loop LANES channels wide (at least the chunk's channel count)
+    template <std::size_t LANES>
+    void generate_lanes(float* out, std::size_t frames, std::size_t base, float* line_end);
+
+    // Advance every channel by frames (on pool if set), writing them to out unless it is null,
+    // and checkpoint each multiple of CHECKPOINT_INTERVAL reached for the first time
+    void advance(float* out, std::uint64_t frames, ThreadPool* pool);
+    void save_checkpoint();
+    void restore_checkpoint(std::size_t index);
+
+public:
+    EMGGenerator(std::size_t channels, float sample_rate, std::uint64_t seed, const EMGSignalParams& params = EMGSignalParams());
+
+    // Fill out with a block of interleaved frames ([frame][channel]) of synthetic EMG
+    void generate(float* out, std::size_t frames);
+
+    // The same, with the channels spread over a thread pool: the output is bit-identical to
+    // generate() for any number of workers
+    void generate(float* out, std::size_t frames, ThreadPool& pool);
+
+    // Continue from frame (as if that many frames had been generated since construction),
+    // so any range of frames can be reproduced on its own. The oscillators carry phase from the
+    // start, so this replays from the last checkpoint at or before frame: at most about half a
+    // generate() of CHECKPOINT_INTERVAL (16384) frames anywhere this generator has already
+    // reached, and O(frame) beyond that (checkpointing along the way).
+    void seek(std::uint64_t frame);
+
+    std::size_t channels() const { return count; }
+    std::uint64_t position() const { return sample_count; }
+
+    // Checkpoint memory: 6 floats per channel every 16384 frames (~2.7 MB an hour for 256
+    // channels at 2 kHz)
+    std::size_t checkpoint_bytes() const { return checkpoints.size() * sizeof(float); }
+};
+
+#endif // EMG_GENERATOR_H
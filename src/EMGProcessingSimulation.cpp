@@ -1,344 +1,967 @@
 // EmgSimulation.cpp
-#include <GLFW/glfw3.h>
+#include "GLFunctions.h"
 #include <vector>
 #include <random>
-#include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
 #include "Filter.h"
+#include "Envelope.h"
+#include "Spectrum.h"
+#include "ChainBank.h"
+#include "ChannelScheduler.h"
+#include "PolyphaseDecimator.h"
+#include "Session.h"
+#include "Arena.h"
+#include "CoefficientCache.h"
+#include "SampleSource.h"
+#include "NetworkSource.h"
+#include "SpscRing.h"
+#include "SignalRenderer.h"
+#include "RunningMax.h"
+#include "Logger.h"
+#include "Latency.h"
+#include "BatchProcessor.h"
+#include "Recording.h"
 
 #define PI 3.14159265358979323846
 
 // Window dimensions for visualization
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 900;
+const char* const WINDOW_TITLE = "EMG Signal Filtering";
 
 // Synthetic EMG signal parameters
-const float SAMPLE_RATE = 2000.0f; // Hz, sampling rate for the simulation
-const float TIME_STEP = 1.0f / SAMPLE_RATE; // Time between samples (seconds)
-const int BUFFER_SIZE = 1000; // Number of samples to display (0.5 seconds at 2000 Hz)
 const float EMG_FREQ = 20.0f; // Base EMG frequency (Hz)
 const float NOISE_AMPLITUDE = 0.2f; // Amplitude of random noise
 const float POWER_LINE_FREQ = 10.0f; // Power line interference frequency (Hz)
 const float POWER_LINE_AMPLITUDE = 0.3f; // Amplitude of power line interference
 
-// Filter parameters
-float HIGHPASS_CUTOFF = 5.0f; // High-pass cutoff frequency (Hz), adjustable
-const float BANDPASS_LOW = 5.0f; // Band-pass low cutoff frequency (Hz)
-float BANDPASS_HIGH = 50.0f; // Band-pass high cutoff frequency (Hz), adjustable
-const float LOWPASS_CUTOFF = 2.0f; // Low-pass cutoff for envelope (Hz)
+// Sample rate, channel count, display window and starting cutoffs, fixed once main() has read
+// the config file and command line
+SessionConfig session;
+
+// Filter parameters (adjustable ones are written by the UI thread and read by the acquisition thread)
+std::atomic<float> HIGHPASS_CUTOFF{5.0f}; // High-pass cutoff frequency (Hz), adjustable, starts at session.highpass_cutoff
+std::atomic<float> BANDPASS_HIGH{50.0f}; // Band-pass high cutoff frequency (Hz), adjustable, starts at session.bandpass_high
+const std::size_t RETUNE_RAMP_SAMPLES = 64; // Coefficient interpolation length when a cutoff changes (32 ms at 2 kHz)
+const float HIGHPASS_STEP = 0.5f; // High-pass cutoff change per key press (Hz)
+const float BANDPASS_STEP = 5.0f; // Band-pass high cutoff change per key press (Hz)
+const float HIGHPASS_MIN = 1.0f; // Lowest high-pass cutoff the keys reach (Hz); the band-pass edge stops at bandpass-low + 1 Hz
+const float HIGHPASS_PRECOMPUTE_MAX = 100.0f; // Upper end of the precomputed high-pass range (Hz)
+const float BANDPASS_PRECOMPUTE_MAX = 500.0f; // Upper end of the precomputed band-pass range (Hz)
+const float PRECOMPUTE_NYQUIST_FRACTION = 0.45f; // Precomputed cutoffs also stay below this fraction of the sample rate
+
+// Lowest point at or above minimum of the lattice start + k * step (any integer k)
+float lattice_origin(float start, float minimum, float step) {
+    return start - std::floor((start - minimum) / step) * step;
+}
+
+// Top of a cutoff's precomputed range: limit, kept below Nyquist, or the session start if higher
+float precompute_top(float limit, float start, float sample_rate) {
+    return std::max(std::min(limit, PRECOMPUTE_NYQUIST_FRACTION * sample_rate), start);
+}
+
+// A cutoff the arrow keys step along a lattice from its session start, clamped at minimum and
+// maximum; a clamp at minimum starts a second lattice there. Values are origin + index * step, computed from the
+// index rather than by adding steps up, so they are bit-identical to the keys the acquisition
+// thread's CoefficientCache precomputed for both lattices and retuning never designs.
+struct CutoffLattice {
+    float origin;
+    float step;
+    float minimum;
+    float maximum;
+    int index;
+
+    CutoffLattice(float start, float minimum, float maximum, float step)
+        : origin(lattice_origin(start, minimum, step)), step(step), minimum(minimum), maximum(maximum),
+          index((int)std::lround((start - origin) / step)) {}
+
+    float value() const { return origin + index * step; }
+    float up() {
+        if (origin + (index + 1) * step <= maximum) {
+            ++index;
+        }
+        return value();
+    }
+    float down() {
+        if (origin + (index - 1) * step < minimum) {
+            origin = minimum;
+            index = 0;
+        } else {
+            --index;
+        }
+        return value();
+    }
+};
+CutoffLattice highpass_lattice(5.0f, HIGHPASS_MIN, HIGHPASS_PRECOMPUTE_MAX, HIGHPASS_STEP); // Render thread; reset from the session in main()
+CutoffLattice bandpass_lattice(50.0f, 6.0f, BANDPASS_PRECOMPUTE_MAX, BANDPASS_STEP);
+
+// Console status lines (sample values, maxima, frame time) are rate limited to this interval
+const int STATUS_LOG_INTERVAL_MS = 500;
 
-// Circular buffers to store the most recent samples for visualization
-std::vector<float> raw_signal(BUFFER_SIZE, 0.0f); // Raw EMG signal
-std::vector<float> filtered_signal(BUFFER_SIZE, 0.0f); // Filtered EMG signal (after high-pass and band-pass)
-std::vector<float> envelope_signal(BUFFER_SIZE, 0.0f); // Envelope signal (rectified and smoothed)
+std::size_t display_samples = 0; // Samples on screen, from session.display_seconds
 int buffer_index = 0; // Current index in the circular buffers
 
-// Random number generator for introducing variability in the EMG signal
-std::random_device rd;
-std::mt19937 gen(rd());
-std::uniform_real_distribution<float> dist(-NOISE_AMPLITUDE, NOISE_AMPLITUDE); // Noise distribution
-std::uniform_real_distribution<float> amp_dist(0.8f, 1.2f); // Amplitude variation (0.8x to 1.2x)
-std::uniform_real_distribution<float> freq_dist(0.9f, 1.1f); // Frequency variation (0.9x to 1.1x)
-std::uniform_real_distribution<float> burst_dist(0.0f, 1.0f); // Probability of burst (0 to 1)
-std::uniform_real_distribution<float> burst_scale(1.0f, 3.0f); // Burst amplitude scaling (1x to 3x)
+// Spectral analysis of the filtered signal (median frequency tracks muscle fatigue)
+const std::size_t SPECTRUM_WINDOW = 1024; // FFT length (0.5 s at 2000 Hz, ~2 Hz resolution)
+const std::size_t SPECTRUM_HOP = 512; // New spectrum every 256 ms at 2000 Hz (50% overlap)
+std::unique_ptr<SpectralAnalyzer> spectral_analyzer; // Created for the session's sample rate
+
+// Peak amplitude over each circular buffer, updated as samples are written (sized with the buffers)
+RunningMax max_raw(1); // Peak |raw|
+RunningMax max_filtered(1); // Peak |filtered|
+RunningMax max_envelope(1); // Peak envelope value
+
+// The display's circular buffers (raw, filtered, envelope), kept in the renderer's vertex arrays
+// on arena storage and uploaded from there; windows wider than two samples per pixel are drawn
+// decimated to min/max pairs per column. Created once the window length is known.
+const std::size_t TRACE_COUNT = 3;
+std::unique_ptr<SignalRenderer> signal_renderer;
+
+// With an envelope-rate, the envelope trace comes from ChainBank's decimated envelope instead,
+// through its own queue into its own renderer, and signal_renderer draws only raw and filtered
+std::size_t envelope_samples = 0; // Envelope samples on screen at envelope-rate; 0 at full rate
+int envelope_index = 0; // Current index in the envelope's circular buffer
+std::unique_ptr<SignalRenderer> envelope_renderer;
+
+// One processed sample handed from the acquisition thread to the render thread
+struct ProcessedSample {
+    float raw;
+    float highpassed;
+    float bandpass_filtered;
+    float rectified;
+    float enveloped;
+};
+static_assert(sizeof(ProcessedSample) == STREAM_COUNT * sizeof(float), "ProcessedSample must match the recorded stream layout");
+
+// Lock-free hand-off between acquisition and rendering (~4 seconds of headroom at 2000 Hz)
+const std::size_t SAMPLE_QUEUE_CAPACITY = 8192;
+SpscRing<ProcessedSample, SAMPLE_QUEUE_CAPACITY> sample_queue;
+SpscRing<float, SAMPLE_QUEUE_CAPACITY> envelope_queue; // Display channel's decimated envelope
+const std::size_t ACQUISITION_BLOCK_SIZE = 64; // Max samples pushed through the filter chain per block
+std::unique_ptr<SampleSource> sample_source; // Synthetic generator by default, or a network receiver
+std::atomic<bool> acquisition_running{true}; // Cleared on shutdown to stop the acquisition thread
+std::atomic<unsigned long> dropped_samples{0}; // Samples the renderer fell too far behind to display
+
+// Latency of each stage, per acquisition block and per rendered frame, shown in the window title
+// and logged on L and at exit. End-to-end runs from a block being acquired to the swap that
+// first shows any of it, taken from the oldest sample drained each frame.
+enum LatencyStageId {
+    LATENCY_SOURCE, // Acquisition thread: sample source (generator or network) for one block
+    LATENCY_MAINS, // ChainBank stages, in chain order (the power-line canceller only if enabled)
+    LATENCY_HIGHPASS,
+    LATENCY_BANDPASS,
+    LATENCY_RECTIFY,
+    LATENCY_ENVELOPE,
+    LATENCY_ONSET,
+    LATENCY_HANDOFF, // Display channel gathered, queued and recorded
+    LATENCY_BLOCK, // Chain and hand-off together
+    LATENCY_EVENT, // From a block being acquired to an onset/offset in it reaching the callback
+    LATENCY_DRAIN, // Render thread: queue drained into the display and analyzer
+    LATENCY_RENDER,
+    LATENCY_SWAP,
+    LATENCY_EVENTS,
+    LATENCY_FRAME, // Whole frame, for frames that were drawn
+    LATENCY_END_TO_END,
+    LATENCY_STAGE_COUNT
+};
+LatencyStage latency_stages[LATENCY_STAGE_COUNT] = {
+    { "source" }, { "mains" }, { "highpass" }, { "bandpass" }, { "rectify" }, { "envelope" }, { "onset" }, { "handoff" },
+    { "block" }, { "onset-event" }, { "drain" }, { "render" }, { "swap" }, { "events" }, { "frame" }, { "end-to-end" },
+};
+const std::int64_t LATENCY_BUDGET_NS = 10000000; // End-to-end budget: 10 ms
+
+// Muscle onsets and offsets from ChainBank's detector, handed from its callback on the acquisition
+// thread to the render thread, which logs the display channel's
+const std::size_t EVENT_QUEUE_CAPACITY = 1024;
+SpscRing<MuscleEvent, EVENT_QUEUE_CAPACITY> event_queue;
+std::atomic<unsigned long> dropped_events{0};
+unsigned long onset_count = 0; // Render thread: onsets seen on every channel
+
+// Acquisition thread: times the event against its block (context points at the block's
+// acquisition time) and queues it; a controller would act on it right here
+void on_muscle_event(void* context, const MuscleEvent& event) {
+    latency_stages[LATENCY_EVENT].histogram.record(event.time - *static_cast<const std::int64_t*>(context));
+    if (!event_queue.try_push(event)) {
+        dropped_events.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// When each block's samples were acquired, so the render thread can tell how old what it shows is
+struct BlockStamp {
+    std::uint64_t end; // Samples queued up to and including this block
+    std::int64_t acquired; // latency_now() when the source handed the block over
+};
+SpscRing<BlockStamp, SAMPLE_QUEUE_CAPACITY> block_stamps; // At most one per queued sample
+BlockStamp pending_stamp; // Render thread: a block only partly drained so far
+bool has_pending_stamp = false;
+
+// Render thread: acquisition time of the oldest sample drained this frame, given the total
+// drained so far including this frame's (call only when the frame drained something). A stamp
+// is kept until every sample of its block has been drained.
+std::int64_t oldest_drained(std::uint64_t drained) {
+    std::int64_t oldest = 0;
+    while (has_pending_stamp || block_stamps.try_pop(pending_stamp)) {
+        has_pending_stamp = true;
+        if (oldest == 0) {
+            oldest = pending_stamp.acquired;
+        }
+        if (pending_stamp.end > drained) {
+            break;
+        }
+        has_pending_stamp = false;
+    }
+    return oldest;
+}
+
+// Check the end-to-end p99.9 against the budget
+void log_latency_budget() {
+    const LatencyHistogram& end_to_end = latency_stages[LATENCY_END_TO_END].histogram;
+    if (end_to_end.count() == 0) {
+        return;
+    }
+    double p999_ms = end_to_end.percentile(0.999) / 1e6;
+    double budget_ms = LATENCY_BUDGET_NS / 1e6;
+    if (p999_ms <= budget_ms) {
+        LOG_INFO("End-to-end p99.9 %.2f ms is within the %g ms budget", p999_ms, budget_ms);
+    } else {
+        LOG_WARNING("End-to-end p99.9 %.2f ms is over the %g ms budget", p999_ms, budget_ms);
+    }
+}
+
+// Show the end-to-end and frame latency percentiles in the window title
+void update_latency_title(GLFWwindow* window) {
+    const LatencyHistogram& end_to_end = latency_stages[LATENCY_END_TO_END].histogram;
+    const LatencyHistogram& frame = latency_stages[LATENCY_FRAME].histogram;
+    char title[160];
+    std::snprintf(title, sizeof(title), "%s - end-to-end p99 %.2f ms, p99.9 %.2f ms | frame p99 %.2f ms", WINDOW_TITLE,
+                  end_to_end.percentile(0.99) / 1e6, end_to_end.percentile(0.999) / 1e6, frame.percentile(0.99) / 1e6);
+    glfwSetWindowTitle(window, title);
+}
+
+// Every channel runs through the session's ChainBank chain, a block of interleaved frames at a
+// time: a ChannelScheduler splits sessions wider than one chunk into ChainBank slices across a
+// thread pool. Its taps come out in RecordedStream order (raw, high-passed, band-passed,
+// rectified, envelope), the same layout as ProcessedSample.
+static_assert(ChainBank::TAPS == STREAM_COUNT, "Chain taps must match the recorded streams");
+static_assert(ChainBank::TIMED_STAGES == LATENCY_HANDOFF - LATENCY_MAINS, "Chain stage timers must match the latency stages");
+
+// Recording (--record) and playback (--play)
+RecordingWriter recorder; // Every processed stream of every channel, written by the acquisition thread when open
+RecordingReader playback; // Mapped recording shown instead of the generator when open
+std::atomic<long long> playback_seek{0}; // Pending seek in frames, accumulated by the key callback
+const float PLAYBACK_SEEK_SHORT = 1.0f; // Seek per LEFT/RIGHT press during playback (seconds)
+const float PLAYBACK_SEEK_LONG = 10.0f; // Seek per PAGE UP/PAGE DOWN press during playback (seconds)
+
+// Workers for the chain when the session has more than one chunk of channels (see ChannelScheduler)
+std::unique_ptr<ThreadPool> chain_pool;
+
+// Every buffer and all per-channel state whose size depends on the session, carved out of a
+// single arena allocation at startup: nothing is allocated or resized while the session runs.
+// Each thread's blocks are grouped and kept apart, so the two never write to the same cache line.
+// carve() is run against an ArenaSizer first to size the arena exactly, then against the arena.
+struct SessionBuffers {
+    // Acquisition thread
+    ChannelScheduler::Storage chain; // Filter and envelope state for every channel, and its stage outputs
+    float* taps; // The display channel's taps for one block, STREAM_COUNT floats per sample
+    float* recorded; // Every channel's taps for one block when recording, [frame][channel][stream]
+
+    // Render thread
+    float* traces; // SignalRenderer storage: the display's circular buffers and their pyramids
+    float* envelope_trace; // envelope_renderer storage, when decimating
+    ProcessedSample* arrived; // Samples drained from sample_queue this frame
+    float* arrived_filtered; // Their filtered values, for the analyzer
+    float* arrived_envelope; // Decimated envelope drained from envelope_queue this frame
+
+    template <typename Allocator>
+    void carve(Allocator& arena) {
+        chain = ChannelScheduler::carve(arena, session, ACQUISITION_BLOCK_SIZE, chain_pool ? chain_pool->size() : 1);
+        taps = arena.template allocate<float>(ACQUISITION_BLOCK_SIZE * STREAM_COUNT);
+        recorded = arena.template allocate<float>(
+            recorder.is_open() && session.channels > 1 ? ACQUISITION_BLOCK_SIZE * session.channels * STREAM_COUNT : 0);
+        arena.separate();
+        const bool decimated = envelope_samples > 0;
+        traces = arena.template allocate<float>(
+            SignalRenderer::storage_floats(display_samples, decimated ? TRACE_COUNT - 1 : TRACE_COUNT, WINDOW_WIDTH));
+        envelope_trace = arena.template allocate<float>(
+            decimated ? SignalRenderer::storage_floats(envelope_samples, 1, WINDOW_WIDTH) : 0);
+        arrived = arena.template allocate<ProcessedSample>(SAMPLE_QUEUE_CAPACITY);
+        arrived_filtered = arena.template allocate<float>(SAMPLE_QUEUE_CAPACITY);
+        arrived_envelope = arena.template allocate<float>(decimated ? SAMPLE_QUEUE_CAPACITY : 0);
+    }
+};
+SessionBuffers buffers;
+std::unique_ptr<Arena> session_arena;
+std::unique_ptr<ChannelScheduler> chain_bank; // On buffers.chain, run on chain_pool if there is one
 
 // State for pause/resume functionality
-bool is_paused = false;
+std::atomic<bool> is_paused{false};
+
+// Frames are drawn only when something on screen changed: new samples, or the window being
+// exposed or resized. Otherwise the last frame stays up and the render thread sleeps in
+// glfwWaitEventsTimeout, woken by input, until the next title update or frame is due.
+const double PAUSED_WAIT_SECONDS = STATUS_LOG_INTERVAL_MS / 1000.0; // Longest idle wait while paused
+const double IDLE_WAIT_SECONDS = 1.0 / 60.0; // Longest idle wait while running with no new samples
+bool redraw_requested = true; // Set by the refresh callback (render thread only)
+unsigned long frames_drawn = 0; // Render thread: frames drawn and swapped
+unsigned long idle_waits = 0; // Render thread: loop iterations that had nothing to draw
+
+// Window contents were damaged (exposed, resized): draw the next frame even with no new samples
+void window_refresh_callback(GLFWwindow*) {
+    redraw_requested = true;
+}
 
 // Callback for key presses to toggle pause/resume and adjust filters
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
-        is_paused = !is_paused;
-        std::cout << (is_paused ? "Simulation Paused" : "Simulation Resumed") << std::endl;
+        is_paused = !is_paused.load();
+        LOG_INFO("%s", is_paused.load() ? "Simulation Paused" : "Simulation Resumed");
+    }
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        log_latency_report(latency_stages, LATENCY_STAGE_COUNT);
+        log_latency_budget();
+    }
+    // During playback the streams are already processed, so the arrow keys scrub instead
+    if (playback.is_open() && (action == GLFW_PRESS || action == GLFW_REPEAT)) {
+        float seconds = 0.0f;
+        if (key == GLFW_KEY_RIGHT) seconds = PLAYBACK_SEEK_SHORT;
+        if (key == GLFW_KEY_LEFT) seconds = -PLAYBACK_SEEK_SHORT;
+        if (key == GLFW_KEY_PAGE_UP) seconds = PLAYBACK_SEEK_LONG;
+        if (key == GLFW_KEY_PAGE_DOWN) seconds = -PLAYBACK_SEEK_LONG;
+        if (key == GLFW_KEY_HOME) seconds = -(float)playback.frames() / playback.sample_rate();
+        playback_seek.fetch_add((long long)(seconds * playback.sample_rate()));
+        return;
     }
     // Adjust filter parameters with arrow keys
     if (action == GLFW_PRESS || action == GLFW_REPEAT) {
         if (key == GLFW_KEY_UP) {
-            HIGHPASS_CUTOFF += 0.5f;
-            std::cout << "High-pass cutoff increased to: " << HIGHPASS_CUTOFF << " Hz" << std::endl;
+            HIGHPASS_CUTOFF = highpass_lattice.up(); // Clamped at the top of the precomputed range
+            LOG_INFO("High-pass cutoff increased to: %g Hz", HIGHPASS_CUTOFF.load());
         }
         if (key == GLFW_KEY_DOWN) {
-            HIGHPASS_CUTOFF = std::max(1.0f, HIGHPASS_CUTOFF - 0.5f); // Ensure cutoff doesn't go below 1 Hz
-            std::cout << "High-pass cutoff decreased to: " << HIGHPASS_CUTOFF << " Hz" << std::endl;
+            HIGHPASS_CUTOFF = highpass_lattice.down(); // Clamped at HIGHPASS_MIN
+            LOG_INFO("High-pass cutoff decreased to: %g Hz", HIGHPASS_CUTOFF.load());
         }
         if (key == GLFW_KEY_RIGHT) {
-            BANDPASS_HIGH += 5.0f;
-            std::cout << "Band-pass high cutoff increased to: " << BANDPASS_HIGH << " Hz" << std::endl;
+            BANDPASS_HIGH = bandpass_lattice.up(); // Clamped at the top of the precomputed range
+            LOG_INFO("Band-pass high cutoff increased to: %g Hz", BANDPASS_HIGH.load());
         }
         if (key == GLFW_KEY_LEFT) {
-            BANDPASS_HIGH = std::max(BANDPASS_LOW + 1.0f, BANDPASS_HIGH - 5.0f); // Ensure high cutoff doesn't go below low cutoff + 1 Hz
-            std::cout << "Band-pass high cutoff decreased to: " << BANDPASS_HIGH << " Hz" << std::endl;
+            BANDPASS_HIGH = bandpass_lattice.down(); // Clamped at bandpass-low + 1 Hz
+            LOG_INFO("Band-pass high cutoff decreased to: %g Hz", BANDPASS_HIGH.load());
         }
     }
 }
 
-// Check for OpenGL errors after a specific operation
-void check_gl_error(const char* operation) {
-    GLenum error = glGetError();
-    if (error != GL_NO_ERROR) {
-        std::cerr << "OpenGL Error after " << operation << ": " << error << std::endl;
+// Render the raw, filtered, and envelope signals using OpenGL
+void render_signals() {
+    // Maximum amplitudes for normalization come from the running trackers, not a buffer scan
+    float max_amplitudes[3] = { max_raw.max(), max_filtered.max(), std::max(0.0f, max_envelope.max()) };
+
+    signal_renderer->render(buffer_index, max_amplitudes);
+    if (envelope_renderer) {
+        envelope_renderer->render(envelope_index, &max_amplitudes[2], false);
     }
 }
 
-// Generate a synthetic EMG signal with random variations
-// Parameters:
-// - t: Current time (seconds)
-// Returns: EMG signal value at time t
-float generate_emg_signal(float t) {
-    static float phase1 = 0.0f; // Phase of first EMG component
-    static float phase2 = 0.0f; // Phase of second EMG component
-    static float burst_factor = 1.0f; // Scaling factor for muscle bursts
-    static int burst_duration = 0; // Duration of current burst (samples)
+// Acquisition thread: filters whatever sample_source has ready, reading each block in place,
+// and hands the results to the render thread through sample_queue. It never waits on the
+// renderer; if the queue is full the sample is still processed but not displayed.
+void acquisition_loop() {
+    const float sample_rate = session.sample_rate;
+    const float bandpass_low = session.bandpass_low;
+
+    // Precompute coefficients for every cutoff the arrow keys can reach, so retuning is a lookup
+    // that never designs or allocates. Each cutoff has two lattices (see CutoffLattice): stepping
+    // from its session value, and from its clamp at minimum; both stop at the same top.
+    CoefficientCache coefficient_cache;
+    const float highpass_max = precompute_top(HIGHPASS_PRECOMPUTE_MAX, session.highpass_cutoff, sample_rate);
+    coefficient_cache.prepopulate_freq1(FilterType::HighPass, sample_rate,
+                                        lattice_origin(session.highpass_cutoff, HIGHPASS_MIN, HIGHPASS_STEP), highpass_max,
+                                        HIGHPASS_STEP);
+    coefficient_cache.prepopulate_freq1(FilterType::HighPass, sample_rate, HIGHPASS_MIN, highpass_max, HIGHPASS_STEP);
+    float bandpass_start = lattice_origin(session.bandpass_high, bandpass_low + 1.0f, BANDPASS_STEP);
+    const float bandpass_max = precompute_top(BANDPASS_PRECOMPUTE_MAX, session.bandpass_high, sample_rate);
+    coefficient_cache.prepopulate_freq2(FilterType::BandPass, sample_rate, bandpass_low, bandpass_start, bandpass_max, BANDPASS_STEP);
+    coefficient_cache.prepopulate_freq2(FilterType::BandPass, sample_rate, bandpass_low, bandpass_low + 1.0f, bandpass_max, BANDPASS_STEP);
+
+    SampleSource& source = *sample_source;
+    const std::size_t channels = source.channels();
+    ChannelScheduler& chains = *chain_bank;
+    const std::size_t display = session.display_channel;
+    float* taps = buffers.taps;
+
+    float last_highpass_cutoff = HIGHPASS_CUTOFF; // Track the last high-pass cutoff to detect changes
+    float last_bandpass_high = BANDPASS_HIGH; // Track the last band-pass high cutoff to detect changes
+
+    const auto tick = std::chrono::milliseconds(1);
+    std::uint64_t queued = 0; // Samples successfully pushed to sample_queue
+    chains.set_stage_timers(&latency_stages[LATENCY_MAINS]); // The first chunk's, in a split session
+    std::int64_t block_acquired = 0; // For on_muscle_event
+    chains.set_event_callback(on_muscle_event, &block_acquired);
+
+    while (acquisition_running.load(std::memory_order_relaxed)) {
+        if (is_paused.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Drop what arrives while paused so resuming doesn't try to catch up
+            source.resync();
+            continue;
+        }
+
+        // Retune every channel's filters in place if their cutoffs have changed, keeping their state
+        float highpass_cutoff = HIGHPASS_CUTOFF;
+        float bandpass_high = BANDPASS_HIGH;
+        if (highpass_cutoff != last_highpass_cutoff) {
+            const BiquadCoefficients c = coefficient_cache.lookup(FilterType::HighPass, sample_rate, highpass_cutoff);
+            chains.set_highpass(c, RETUNE_RAMP_SAMPLES);
+            last_highpass_cutoff = highpass_cutoff;
+            LOG_INFO("High-pass filter retuned to cutoff: %g Hz", highpass_cutoff);
+        }
+        if (bandpass_high != last_bandpass_high) {
+            const BiquadCoefficients c = coefficient_cache.lookup(FilterType::BandPass, sample_rate, bandpass_low, bandpass_high);
+            chains.set_bandpass(c, RETUNE_RAMP_SAMPLES);
+            last_bandpass_high = bandpass_high;
+            LOG_INFO("Band-pass filter retuned to high cutoff: %g Hz", bandpass_high);
+        }
 
-    if (buffer_index % 50 == 0) {
-        if (burst_dist(gen) < 0.2f) { // 20% chance of a burst
-            burst_factor = burst_scale(gen); // Scale amplitude by 1x to 3x
-            burst_duration = 100; // Burst lasts 50 ms (100 samples)
-        } else if (burst_duration <= 0) {
-            burst_factor = 1.0f; // Reset to no scaling
+        // Filter every block the source has ready, all channels at once, straight from the
+        // source's storage
+        std::size_t frames;
+        std::int64_t acquire_start = latency_now();
+        while (const float* block = source.acquire(frames)) {
+            const std::int64_t acquired = latency_now();
+            block_acquired = acquired;
+            latency_stages[LATENCY_SOURCE].histogram.record(acquired - acquire_start);
+            for (std::size_t done = 0; done < frames; done += ACQUISITION_BLOCK_SIZE) {
+                std::size_t n = std::min(frames - done, ACQUISITION_BLOCK_SIZE);
+                ScopedTimer block_timer(latency_stages[LATENCY_BLOCK].histogram);
+                chains.process(block + done * channels, n);
+                ScopedTimer handoff_timer(latency_stages[LATENCY_HANDOFF].histogram);
+
+                // Gather the display channel into ProcessedSample (RecordedStream) order
+                for (std::size_t t = 0; t < STREAM_COUNT; ++t) {
+                    const float* tap = chains.tap(t) + display;
+                    for (std::size_t i = 0; i < n; ++i) {
+                        taps[i * STREAM_COUNT + t] = tap[i * channels];
+                    }
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    ProcessedSample sample;
+                    std::memcpy(&sample, &taps[i * STREAM_COUNT], sizeof(sample));
+                    if (sample_queue.try_push(sample)) {
+                        ++queued;
+                    } else {
+                        dropped_samples.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                block_stamps.try_push({ queued, acquired });
+                const float* decimated = chains.decimated_envelope() + display;
+                for (std::size_t i = 0; i < chains.decimated_frames(); ++i) {
+                    envelope_queue.try_push(decimated[i * channels]);
+                }
+                if (recorder.is_open()) {
+                    // One channel's frames are the display taps already; otherwise gather them all
+                    const float* recorded = taps;
+                    if (channels > 1) {
+                        for (std::size_t t = 0; t < STREAM_COUNT; ++t) {
+                            const float* tap = chains.tap(t);
+                            for (std::size_t i = 0; i < n * channels; ++i) {
+                                buffers.recorded[i * STREAM_COUNT + t] = tap[i];
+                            }
+                        }
+                        recorded = buffers.recorded;
+                    }
+                    recorder.write(recorded, n);
+                }
+            }
+            source.release();
+            acquire_start = latency_now();
         }
+
+        std::this_thread::sleep_for(tick);
     }
-    if (burst_duration > 0) {
-        burst_duration--;
+    if (coefficient_cache.misses() > 0) {
+        LOG_INFO("%zu filter retunes were outside the precomputed cutoffs and designed on the fly",
+                 coefficient_cache.misses());
     }
+}
 
-    // Generate two EMG components with random amplitude and frequency variations
-    float amp1 = 0.5f * amp_dist(gen); // Amplitude of first component (0.4 to 0.6)
-    float amp2 = 0.3f * amp_dist(gen); // Amplitude of second component (0.24 to 0.36)
-    float freq1 = EMG_FREQ * freq_dist(gen); // Frequency of first component (18 to 22 Hz)
-    float freq2 = (EMG_FREQ * 1.5f) * freq_dist(gen); // Frequency of second component (27 to 33 Hz)
+// Playback thread: replays a mapped recording at its own sample rate in place of acquisition_loop.
+// Samples are read directly from the mapping, so seeking costs nothing. Channels follow
+// RecordedStream order, STREAM_COUNT per source channel, and the display channel's are shown;
+// streams the recording doesn't have are shown as zero.
+void playback_loop() {
+    using clock = std::chrono::steady_clock;
+
+    const std::uint64_t frames = playback.frames();
+    const std::uint32_t channels = playback.channels();
+    const std::uint32_t first = (std::uint32_t)(session.display_channel * STREAM_COUNT); // Display channel's raw stream
+    const float sample_rate = playback.sample_rate();
+    std::uint64_t position = 0;
+
+    auto origin = clock::now();
+    long long produced = 0;
+    const auto tick = std::chrono::milliseconds(1);
+
+    // The recorded envelope is at full rate; bring it down to envelope-rate the way the chain would
+    PolyphaseDecimator decimator;
+    if (envelope_samples > 0) {
+        decimator = PolyphaseDecimator(1, sample_rate, session.envelope_rate, 1);
+    }
 
-    // Update phases for continuous sine waves
-    phase1 += 2.0f * PI * freq1 * TIME_STEP;
-    phase2 += 2.0f * PI * freq2 * TIME_STEP;
+    while (acquisition_running.load(std::memory_order_relaxed)) {
+        if (is_paused.load(std::memory_order_relaxed) && playback_seek.load(std::memory_order_relaxed) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            origin = clock::now();
+            produced = 0;
+            continue;
+        }
 
-    // Combine EMG components, apply burst scaling, and add interference and noise
-    float emg = burst_factor * (amp1 * sin(phase1) + amp2 * sin(phase2));
-    emg += POWER_LINE_AMPLITUDE * sin(2.0f * PI * POWER_LINE_FREQ * t);
-    emg += dist(gen);
+        long long seek = playback_seek.exchange(0);
+        if (seek != 0) {
+            long long target = std::max(0LL, std::min((long long)frames - 1, (long long)position + seek));
+            position = (std::uint64_t)target;
+            decimator.reset();
+            LOG_INFO("Playback position: %.1f s of %.1f s", position / sample_rate, frames / sample_rate);
+        }
 
-    // Check for numerical stability
-    if (std::isnan(emg) || std::isinf(emg)) {
-        std::cerr << "Warning: Generated EMG signal is NaN or Inf at t = " << t << std::endl;
-        return 0.0f; // Return a safe value to prevent crashes
-    }
+        auto now = clock::now();
+        long long due = (long long)(std::chrono::duration<double>(now - origin).count() * sample_rate);
+        for (; produced < due; ++produced) {
+            if (position >= frames) {
+                position = 0;
+                LOG_INFO("End of recording, looping to start");
+            }
+            float values[STREAM_COUNT] = {};
+            for (std::uint32_t c = 0; first + c < channels && c < STREAM_COUNT; ++c) {
+                values[c] = playback.sample(position, first + c);
+            }
+            ProcessedSample sample;
+            std::memcpy(&sample, values, sizeof(sample));
+            if (!sample_queue.try_push(sample)) {
+                dropped_samples.fetch_add(1, std::memory_order_relaxed);
+            }
+            float decimated[2];
+            if (decimator.process(&values[STREAM_ENVELOPE], 1, decimated) > 0) {
+                envelope_queue.try_push(decimated[0]);
+            }
+            ++position;
+        }
+        // A seek while paused is the only new display; wake the render thread from its idle wait
+        if (seek != 0 && is_paused.load(std::memory_order_relaxed)) {
+            glfwPostEmptyEvent();
+        }
 
-    return emg;
+        std::this_thread::sleep_until(now + tick);
+    }
 }
 
-// Normalize a signal value for visualization
-// Parameters:
-// - value: Signal value to normalize
-// - max_amplitude: Maximum amplitude for scaling
-// Returns: Normalized value in the range [-display_range, display_range]
-float normalize_for_display(float value, float max_amplitude) {
-    const float display_range = 0.5f; // Amplitude range to prevent overlap
-    if (max_amplitude == 0.0f) {
-        std::cerr << "Warning: Max amplitude is zero, normalization skipped" << std::endl;
-        return value;
-    }
-    return (value / max_amplitude) * display_range;
-}
+int main(int argc, char** argv) {
+    // All console output goes through the asynchronous logger; the session flushes it on every return
+    LoggerSession logger_session;
 
-// Render the raw, filtered, and envelope signals using OpenGL
-void render_signals() {
-    glClear(GL_COLOR_BUFFER_BIT);
-    check_gl_error("glClear");
-
-    // Calculate maximum amplitudes for normalization
-    float max_raw = 0.0f;
-    float max_filtered = 0.0f;
-    float max_envelope = 0.0f;
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        max_raw = std::max(max_raw, std::abs(raw_signal[i]));
-        max_filtered = std::max(max_filtered, std::abs(filtered_signal[i]));
-        max_envelope = std::max(max_envelope, envelope_signal[i]);
-    }
-
-    // Render raw EMG signal (top, red)
-    glColor3f(1.0f, 0.0f, 0.0f); // Red
-    check_gl_error("glColor3f (raw)");
-    glBegin(GL_LINE_STRIP);
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        float x = -1.0f + 2.0f * i / (float)(BUFFER_SIZE - 1);
-        float y = 0.75f + normalize_for_display(raw_signal[(buffer_index + i) % BUFFER_SIZE], max_raw);
-        glVertex2f(x, y);
-    }
-    glEnd();
-    check_gl_error("glEnd (raw)");
-
-    // Draw zero line for raw EMG signal
-    glColor3f(0.5f, 0.5f, 0.5f); // Gray
-    glBegin(GL_LINES);
-    glVertex2f(-1.0f, 0.75f);
-    glVertex2f(1.0f, 0.75f);
-    glEnd();
-
-    // Render filtered signal (middle, green)
-    glColor3f(0.0f, 1.0f, 0.0f); // Green
-    check_gl_error("glColor3f (filtered)");
-    glBegin(GL_LINE_STRIP);
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        float x = -1.0f + 2.0f * i / (float)(BUFFER_SIZE - 1);
-        float y = 0.0f + normalize_for_display(filtered_signal[(buffer_index + i) % BUFFER_SIZE], max_filtered);
-        glVertex2f(x, y);
-    }
-    glEnd();
-    check_gl_error("glEnd (filtered)");
-
-    // Draw zero line for filtered signal
-    glColor3f(0.5f, 0.5f, 0.5f);
-    glBegin(GL_LINES);
-    glVertex2f(-1.0f, 0.0f);
-    glVertex2f(1.0f, 0.0f);
-    glEnd();
-
-    // Render envelope signal (bottom, blue)
-    glColor3f(0.0f, 0.0f, 1.0f); // Blue
-    check_gl_error("glColor3f (envelope)");
-    glBegin(GL_LINE_STRIP);
-    for (int i = 0; i < BUFFER_SIZE; ++i) {
-        float x = -1.0f + 2.0f * i / (float)(BUFFER_SIZE - 1);
-        float y = -0.75f + normalize_for_display(envelope_signal[(buffer_index + i) % BUFFER_SIZE], max_envelope);
-        glVertex2f(x, y);
-    }
-    glEnd();
-    check_gl_error("glEnd (envelope)");
-
-    // Draw zero line for envelope signal
-    glColor3f(0.5f, 0.5f, 0.5f); // Gray
-    glBegin(GL_LINES);
-    glVertex2f(-1.0f, -0.75f);
-    glVertex2f(1.0f, -0.75f);
-    glEnd();
-}
+    // Headless mode: run the filter chain over recorded files as fast as possible, no window
+    if (argc > 1 && std::strcmp(argv[1], "--batch") == 0) {
+        return run_batch(argc - 2, argv + 2, session);
+    }
+
+    // Viewer options: --record <file.emgrec> saves every stream of every channel, --play <file.emgrec>
+    // shows a recording (the display channel's streams, for a multi-channel one),
+    // --udp <port> or --tcp <host> <port> takes live samples from the network, --config <file> reads
+    // session options, --seed <n> makes the synthetic signal repeat from run to run, and every session
+    // option (see Session.h) can also be given as --<name> <value>.
+    // Options apply in order, so flags after --config override the file.
+    const char* record_path = nullptr;
+    const char* seed_text = nullptr;
+    const char* play_path = nullptr;
+    const char* tcp_host = nullptr;
+    int network_port = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--play") == 0 && i + 1 < argc) {
+            play_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--udp") == 0 && i + 1 < argc) {
+            network_port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tcp") == 0 && i + 2 < argc) {
+            tcp_host = argv[++i];
+            network_port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed_text = argv[++i];
+        } else if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            if (!load_session_config(argv[++i], session)) {
+                return -1;
+            }
+        } else if (std::strncmp(argv[i], "--", 2) == 0 && is_session_option(argv[i] + 2) && i + 1 < argc) {
+            if (!set_session_option(session, argv[i] + 2, argv[i + 1])) {
+                return -1;
+            }
+            ++i;
+        } else {
+            LOG_ERROR("Unknown argument: %s", argv[i]);
+            LOG_INFO("Usage: EMGSimulation [--record <file.emgrec> | --play <file.emgrec>] "
+                     "[--udp <port> | --tcp <host> <port> | --seed <n>] [--config <file>] [--sample-rate <hz>] [--channels <n>] "
+                     "[--display-channel <n>] [--window <seconds>] [--highpass <hz>] [--bandpass-low <hz>] "
+                     "[--bandpass-high <hz>] [--lowpass <hz>] [--envelope lowpass|average|rms] "
+                     "[--envelope-window <ms>] [--mains <hz> [--mains-harmonics <n>] [--mains-step <mu>]] [--envelope-rate <hz>] "
+                     "[--onset <level> [--offset <level>] [--onset-hold <ms>] [--onset-signal envelope|tkeo]], "
+                     "or EMGSimulation --batch ...");
+            return -1;
+        }
+    }
+    if (play_path) {
+        if (record_path) {
+            LOG_ERROR("--record and --play can't be combined");
+            return -1;
+        }
+        if (!playback.open(play_path)) {
+            return -1;
+        }
+        const RecordingHeader& info = playback.info();
+        LOG_INFO("Playing %s: %u channels, %.1f s at %g Hz (recorded with high-pass %g Hz, band-pass %g-%g Hz)",
+                 play_path, info.channels, info.frames / info.sample_rate, info.sample_rate,
+                 info.highpass_cutoff, info.bandpass_low, info.bandpass_high);
+        // The display window is measured at the recording's rate, and its channels are the source's
+        session.sample_rate = info.sample_rate;
+        session.channels = std::max<std::size_t>(1, info.channels / STREAM_COUNT);
+    }
+    if (!validate_session_config(session)) {
+        return -1;
+    }
+    HIGHPASS_CUTOFF = session.highpass_cutoff;
+    BANDPASS_HIGH = session.bandpass_high;
+    highpass_lattice = CutoffLattice(session.highpass_cutoff, HIGHPASS_MIN,
+                                     precompute_top(HIGHPASS_PRECOMPUTE_MAX, session.highpass_cutoff, session.sample_rate),
+                                     HIGHPASS_STEP);
+    bandpass_lattice = CutoffLattice(session.bandpass_high, session.bandpass_low + 1.0f,
+                                     precompute_top(BANDPASS_PRECOMPUTE_MAX, session.bandpass_high, session.sample_rate),
+                                     BANDPASS_STEP);
+    display_samples = session_display_samples(session);
+    envelope_samples = session_envelope_samples(session);
+
+    if (network_port != 0) {
+        if (network_port < 0 || network_port > 65535) {
+            LOG_ERROR("Invalid network port");
+            return -1;
+        }
+        // Packets must arrive at the session's sample rate; the filters are designed for it
+        std::unique_ptr<NetworkSource> receiver(new NetworkSource(session.channels, session.sample_rate));
+        bool opened = tcp_host ? receiver->open_tcp(tcp_host, (std::uint16_t)network_port)
+                               : receiver->open_udp((std::uint16_t)network_port);
+        if (!opened) {
+            return -1;
+        }
+        sample_source = std::move(receiver);
+    } else {
+        // Synthetic signal source, seeded nondeterministically unless --seed was given; the seed is
+        // logged so any run can be repeated
+        std::uint64_t seed;
+        if (seed_text) {
+            char* end = nullptr;
+            seed = std::strtoull(seed_text, &end, 0);
+            if (end == seed_text || *end != '\0') {
+                LOG_ERROR("Invalid seed: %s", seed_text);
+                return -1;
+            }
+        } else {
+            std::random_device rd;
+            seed = ((std::uint64_t)rd() << 32) | rd();
+        }
+        LOG_INFO("Synthetic source seed: %llu", (unsigned long long)seed);
+        EMGSignalParams signal_params;
+        signal_params.emg_freq = EMG_FREQ;
+        signal_params.noise_amplitude = NOISE_AMPLITUDE;
+        signal_params.power_line_freq = POWER_LINE_FREQ;
+        signal_params.power_line_amplitude = POWER_LINE_AMPLITUDE;
+        sample_source.reset(new SyntheticSource(session.channels, session.sample_rate, seed, signal_params,
+                                                ACQUISITION_BLOCK_SIZE));
+    }
+    if (record_path) {
+        // The header holds the startup cutoffs; retuning during the recording isn't tracked
+        RecordingSettings settings;
+        settings.sample_rate = session.sample_rate;
+        settings.channels = (std::uint32_t)(STREAM_COUNT * session.channels);
+        settings.highpass_cutoff = session.highpass_cutoff;
+        settings.bandpass_low = session.bandpass_low;
+        settings.bandpass_high = session.bandpass_high;
+        settings.lowpass_cutoff = session.lowpass_cutoff;
+        if (!recorder.open(record_path, settings)) {
+            return -1;
+        }
+        LOG_INFO("Recording every stream of %zu channel(s) to %s", session.channels, record_path);
+    }
+
+    // One worker per core (the acquisition thread helps too) for sessions wider than one chunk;
+    // unpinned, so the workers don't sit on the render thread's core
+    const std::size_t chunks = ChannelScheduler::chunk_count(session.channels);
+    if (chunks > 1) {
+        std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        chain_pool.reset(new ThreadPool(std::min(cores, chunks), false));
+    }
 
-int main() {
-    std::cout << "Starting program..." << std::endl;
-    std::cout << "Red (Top): Initial Signal (Raw EMG)" << std::endl;
-    std::cout << "Green (Middle): Filtered Signal" << std::endl;
-    std::cout << "Blue (Bottom): Envelope Signal (Rectified + Smoothed)" << std::endl;
-    std::cout << "Press SPACE to pause/resume the simulation" << std::endl;
-    std::cout << "Press UP/DOWN to adjust high-pass filter cutoff (current: " << HIGHPASS_CUTOFF << " Hz)" << std::endl;
-    std::cout << "Press LEFT/RIGHT to adjust band-pass high cutoff (current: " << BANDPASS_HIGH << " Hz)" << std::endl;
+    // Carve the session's buffers and per-channel state out of one allocation
+    ArenaSizer sizer;
+    buffers.carve(sizer);
+    session_arena.reset(new Arena(sizer.bytes()));
+    if (!session_arena->is_valid()) {
+        LOG_ERROR("Failed to allocate %zu bytes for the session buffers", sizer.bytes());
+        return -1;
+    }
+    buffers.carve(*session_arena);
+    chain_bank.reset(new ChannelScheduler(session, ACQUISITION_BLOCK_SIZE, buffers.chain, chain_pool.get()));
+
+    spectral_analyzer.reset(new SpectralAnalyzer(1, session.sample_rate, SPECTRUM_WINDOW, SPECTRUM_HOP));
+    max_raw = RunningMax(display_samples);
+    max_filtered = RunningMax(display_samples);
+    max_envelope = RunningMax(envelope_samples > 0 ? envelope_samples : display_samples);
+    // Raw (top, red), filtered (middle, green), envelope (bottom, blue)
+    std::vector<TraceStyle> styles = {
+        { 1.0f, 0.0f, 0.0f, 0.75f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, -0.75f },
+    };
+    if (envelope_samples > 0) {
+        envelope_renderer.reset(new SignalRenderer(envelope_samples, { styles.back() }, WINDOW_WIDTH, buffers.envelope_trace));
+        styles.pop_back();
+    }
+    signal_renderer.reset(new SignalRenderer(display_samples, styles, WINDOW_WIDTH, buffers.traces));
+
+    LOG_INFO("Starting program...");
+    log_session_config(session);
+    LOG_INFO("Session buffers: %zu bytes in one allocation", session_arena->bytes_used());
+    if (chain_pool) {
+        LOG_INFO("Chain split into %zu chunks of up to %zu channels over %zu worker(s)", chunks,
+                 SCHEDULER_CHUNK_CHANNELS, chain_pool->size());
+    }
+    if (signal_renderer->is_decimated()) {
+        LOG_INFO("Display window drawn as the min/max of %zu samples per pixel column", display_samples / WINDOW_WIDTH);
+    }
+    LOG_INFO("Red (Top): Initial Signal (Raw EMG)");
+    LOG_INFO("Green (Middle): Filtered Signal");
+    LOG_INFO("Blue (Bottom): Envelope Signal (Rectified + Smoothed)");
+    if (envelope_renderer) {
+        LOG_INFO("Envelope shown at %g Hz, %.0f ms behind the other traces (decimation filter delay)", session.envelope_rate,
+                 1000.0f * chain_bank->decimation_delay() / session.sample_rate);
+    }
+    LOG_INFO("Press SPACE to pause/resume the simulation");
+    LOG_INFO("Press L to log per-stage latency percentiles (also shown in the window title)");
+    if (playback.is_open()) {
+        LOG_INFO("Press LEFT/RIGHT to seek %g s, PAGE UP/PAGE DOWN to seek %g s, HOME to restart", PLAYBACK_SEEK_SHORT, PLAYBACK_SEEK_LONG);
+    } else {
+        LOG_INFO("Press UP/DOWN to adjust high-pass filter cutoff (current: %g Hz)", HIGHPASS_CUTOFF.load());
+        LOG_INFO("Press LEFT/RIGHT to adjust band-pass high cutoff (current: %g Hz)", BANDPASS_HIGH.load());
+    }
 
     if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
+        LOG_ERROR("Failed to initialize GLFW");
         return -1;
     }
-    std::cout << "GLFW initialized successfully" << std::endl;
+    LOG_INFO("GLFW initialized successfully");
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "EMG Signal Filtering", nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
     if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
         glfwTerminate();
         return -1;
     }
-    std::cout << "GLFW window created successfully" << std::endl;
+    LOG_INFO("GLFW window created successfully");
 
     glfwMakeContextCurrent(window);
 
     // Set up key callback for pause/resume and filter adjustments
     glfwSetKeyCallback(window, key_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
     const GLubyte* version = glGetString(GL_VERSION);
     if (!version) {
-        std::cerr << "Failed to get OpenGL version - OpenGL context might not be properly initialized" << std::endl;
+        LOG_ERROR("Failed to get OpenGL version - OpenGL context might not be properly initialized");
         glfwDestroyWindow(window);
         glfwTerminate();
         return -1;
     }
-    std::cout << "OpenGL Version: " << version << std::endl;
+    LOG_INFO("OpenGL Version: %s", (const char*)version);
 
     const GLubyte* renderer = glGetString(GL_RENDERER);
     const GLubyte* vendor = glGetString(GL_VENDOR);
     if (!renderer || !vendor) {
-        std::cerr << "Failed to get OpenGL renderer or vendor information" << std::endl;
+        LOG_ERROR("Failed to get OpenGL renderer or vendor information");
         glfwDestroyWindow(window);
         glfwTerminate();
         return -1;
     }
-    std::cout << "Renderer: " << renderer << std::endl;
-    std::cout << "Vendor: " << vendor << std::endl;
+    LOG_INFO("Renderer: %s", (const char*)renderer);
+    LOG_INFO("Vendor: %s", (const char*)vendor);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    check_gl_error("glClearColor");
+    GL_CHECK("glClearColor");
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     glOrtho(-1.0, 1.0, -1.5, 1.5, -1.0, 1.0);
-    check_gl_error("glOrtho");
+    GL_CHECK("glOrtho");
     glMatrixMode(GL_MODELVIEW);
-    check_gl_error("glMatrixMode");
+    GL_CHECK("glMatrixMode");
 
-    std::cout << "OpenGL setup complete, entering main loop..." << std::endl;
+    if (!signal_renderer->init() || (envelope_renderer && !envelope_renderer->init())) {
+        LOG_ERROR("Failed to set up signal rendering - OpenGL 2.0 or newer is required");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
 
-    // Create filter instances
-    Filter highPassFilter(FilterType::HighPass, SAMPLE_RATE, HIGHPASS_CUTOFF);
-    Filter bandPassFilter(FilterType::BandPass, SAMPLE_RATE, BANDPASS_LOW, BANDPASS_HIGH);
-    Filter lowPassFilter(FilterType::LowPass, SAMPLE_RATE, LOWPASS_CUTOFF);
+    LOG_INFO("OpenGL setup complete, entering main loop...");
 
-    float t = 0.0f;
-    float last_highpass_cutoff = HIGHPASS_CUTOFF; // Track the last high-pass cutoff to detect changes
-    float last_bandpass_high = BANDPASS_HIGH; // Track the last band-pass high cutoff to detect changes
+    // Start acquisition on its own clock; the render loop below only consumes what has arrived
+    std::thread acquisition_thread(playback.is_open() ? playback_loop : acquisition_loop);
+
+    std::uint64_t drained = 0; // Samples taken from sample_queue so far
+    std::int64_t next_title_update = latency_now();
+    const std::int64_t title_interval = (std::int64_t)STATUS_LOG_INTERVAL_MS * 1000000;
 
     while (!glfwWindowShouldClose(window)) {
-        auto start = std::chrono::high_resolution_clock::now();
+        const std::int64_t frame_start = latency_now();
+        ScopedTimer drain_timer(latency_stages[LATENCY_DRAIN].histogram);
+
+        // Drain every sample produced since the last frame into the display buffers
+        bool report = false;
+        std::size_t count = sample_queue.pop_bulk(buffers.arrived, SAMPLE_QUEUE_CAPACITY);
+        drained += count;
+        const std::int64_t oldest = count > 0 ? oldest_drained(drained) : 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const ProcessedSample& sample = buffers.arrived[i];
+            buffers.arrived_filtered[i] = sample.bandpass_filtered;
+            signal_renderer->write(0, buffer_index, sample.raw);
+            signal_renderer->write(1, buffer_index, sample.bandpass_filtered);
+            max_raw.push(std::abs(sample.raw));
+            max_filtered.push(std::abs(sample.bandpass_filtered));
+            if (!envelope_renderer) {
+                signal_renderer->write(2, buffer_index, sample.enveloped);
+                max_envelope.push(sample.enveloped);
+            }
+
+            if (++buffer_index == (int)display_samples) {
+                buffer_index = 0;
+            }
 
-        // Reinitialize filters if their cutoffs have changed
-        if (HIGHPASS_CUTOFF != last_highpass_cutoff) {
-            highPassFilter = Filter(FilterType::HighPass, SAMPLE_RATE, HIGHPASS_CUTOFF);
-            last_highpass_cutoff = HIGHPASS_CUTOFF;
-            std::cout << "High-pass filter reinitialized with cutoff: " << HIGHPASS_CUTOFF << " Hz" << std::endl;
+            if (buffer_index % 100 == 0) {
+                report = true;
+                LOG_EVERY(STATUS_LOG_INTERVAL_MS, LogLevel::Info, "Raw: %g, High-passed: %g, Band-passed: %g, Rectified: %g, Enveloped: %g",
+                          sample.raw, sample.highpassed, sample.bandpass_filtered, sample.rectified, sample.enveloped);
+                LOG_EVERY(STATUS_LOG_INTERVAL_MS, LogLevel::Info, "Max Raw Amplitude: %g, Max Filtered Amplitude: %g, Max Envelope: %g",
+                          max_raw.max(), max_filtered.max(), max_envelope.max());
+            }
         }
-        if (BANDPASS_HIGH != last_bandpass_high) {
-            bandPassFilter = Filter(FilterType::BandPass, SAMPLE_RATE, BANDPASS_LOW, BANDPASS_HIGH);
-            last_bandpass_high = BANDPASS_HIGH;
-            std::cout << "Band-pass filter reinitialized with high cutoff: " << BANDPASS_HIGH << " Hz" << std::endl;
+
+        std::size_t envelope_count = 0;
+        if (envelope_renderer) {
+            envelope_count = envelope_queue.pop_bulk(buffers.arrived_envelope, SAMPLE_QUEUE_CAPACITY);
+            for (std::size_t i = 0; i < envelope_count; ++i) {
+                envelope_renderer->write(0, envelope_index, buffers.arrived_envelope[i]);
+                max_envelope.push(buffers.arrived_envelope[i]);
+                if (++envelope_index == (int)envelope_samples) {
+                    envelope_index = 0;
+                }
+            }
         }
 
-        // Only update signals if not paused
-        if (!is_paused) {
-            float raw = generate_emg_signal(t);
-            float highpassed = highPassFilter.process(raw);
-            float bandpass_filtered = bandPassFilter.process(highpassed);
-            float rectified = rectify(bandpass_filtered);
-            float enveloped = lowPassFilter.process(rectified);
+        MuscleEvent event;
+        while (event_queue.try_pop(event)) {
+            onset_count += event.type == MuscleEventType::Onset;
+            if (event.channel == session.display_channel) {
+                LOG_INFO("Muscle %s at %.3f s (fired %.1f ms later, level %g)",
+                         event.type == MuscleEventType::Onset ? "onset" : "offset", event.frame / session.sample_rate,
+                         (event.detected - event.frame) * 1000.0f / session.sample_rate, event.level);
+            }
+        }
 
-            raw_signal[buffer_index] = raw;
-            filtered_signal[buffer_index] = bandpass_filtered;
-            envelope_signal[buffer_index] = enveloped;
+        // Same windows the filtered trace shows, analyzed hop by hop as they fill
+        if (spectral_analyzer->process(buffers.arrived_filtered, count) > 0) {
+            const SpectralResult& spectrum = spectral_analyzer->result(0);
+            LOG_EVERY(STATUS_LOG_INTERVAL_MS, LogLevel::Info, "Median frequency: %.1f Hz, mean frequency: %.1f Hz, power: %g",
+                      spectrum.median_frequency, spectrum.mean_frequency, spectrum.total_power);
+        }
 
-            buffer_index = (buffer_index + 1) % BUFFER_SIZE;
-            t += TIME_STEP;
+        drain_timer.stop();
 
-            if (buffer_index % 100 == 0) {
-                float max_raw = *std::max_element(raw_signal.begin(), raw_signal.end(), [](float a, float b) { return std::abs(a) < std::abs(b); });
-                float max_filtered = *std::max_element(filtered_signal.begin(), filtered_signal.end(), [](float a, float b) { return std::abs(a) < std::abs(b); });
-                float max_envelope = *std::max_element(envelope_signal.begin(), envelope_signal.end());
-                std::cout << "Raw: " << raw << ", High-passed: " << highpassed << ", Band-passed: " << bandpass_filtered 
-                          << ", Rectified: " << rectified << ", Enveloped: " << enveloped << std::endl;
-                std::cout << "Max Raw Amplitude: " << max_raw << ", Max Filtered Amplitude: " << max_filtered 
-                          << ", Max Envelope: " << max_envelope << std::endl;
+        // Nothing new to show: keep the last frame up and sleep until input or the next frame is due
+        if (count == 0 && envelope_count == 0 && !redraw_requested) {
+            ++idle_waits;
+            glfwWaitEventsTimeout(is_paused.load(std::memory_order_relaxed) ? PAUSED_WAIT_SECONDS : IDLE_WAIT_SECONDS);
+            const std::int64_t now = latency_now();
+            if (now >= next_title_update) {
+                update_latency_title(window);
+                next_title_update = now + title_interval;
             }
+            continue;
         }
+        redraw_requested = false;
 
-        render_signals();
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            ScopedTimer timer(latency_stages[LATENCY_RENDER].histogram);
+            render_signals();
+        }
+        {
+            ScopedTimer timer(latency_stages[LATENCY_SWAP].histogram);
+            glfwSwapBuffers(window);
+        }
+        ++frames_drawn;
+        if (oldest != 0) {
+            latency_stages[LATENCY_END_TO_END].histogram.record(latency_now() - oldest);
+        }
+        {
+            ScopedTimer timer(latency_stages[LATENCY_EVENTS].histogram);
+            glfwPollEvents();
+        }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-        if (buffer_index % 100 == 0) {
-            std::cout << "Frame time: " << duration << " microseconds" << std::endl;
+        const std::int64_t frame_end = latency_now();
+        latency_stages[LATENCY_FRAME].histogram.record(frame_end - frame_start);
+        if (frame_end >= next_title_update) {
+            update_latency_title(window);
+            next_title_update = frame_end + title_interval;
+        }
+        if (report) {
+            LOG_EVERY(STATUS_LOG_INTERVAL_MS, LogLevel::Info, "Frame time: %lld microseconds, p99 %.1f us (%zu samples this frame, %lu dropped from display)",
+                      (long long)((frame_end - frame_start) / 1000), latency_stages[LATENCY_FRAME].histogram.percentile(0.99) / 1000.0,
+                      count, dropped_samples.load(std::memory_order_relaxed));
         }
     }
 
-    std::cout << "Cleaning up..." << std::endl;
+    acquisition_running = false;
+    acquisition_thread.join();
+    log_latency_report(latency_stages, LATENCY_STAGE_COUNT);
+    log_latency_budget();
+    LOG_INFO("Frames drawn: %lu (%lu idle waits with nothing new to show)", frames_drawn, idle_waits);
+    if (chain_bank->detects_onsets()) {
+        LOG_INFO("Muscle onsets detected: %lu across %zu channel(s) (%lu events dropped)", onset_count, session.channels,
+                 dropped_events.load(std::memory_order_relaxed));
+    }
+    if (recorder.is_open()) {
+        unsigned long long recorded = recorder.frames();
+        unsigned long long skipped = recorder.dropped_frames();
+        if (recorder.close()) {
+            LOG_INFO("Recorded %llu frames (%llu dropped)", recorded, skipped);
+        }
+    }
+    playback.close();
+    sample_source.reset();
+    chain_bank.reset();
+    chain_pool.reset();
+
+    LOG_INFO("Cleaning up...");
+    signal_renderer->shutdown();
+    if (envelope_renderer) {
+        envelope_renderer->shutdown();
+    }
     glfwDestroyWindow(window);
     glfwTerminate();
-    std::cout << "Program exited successfully" << std::endl;
+    LOG_INFO("Program exited successfully");
     return 0;
 }
\ No newline at end of file
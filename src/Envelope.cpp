@@ -0,0 +1,201 @@
+#include "Envelope.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bool parse_envelope_type(const char* text, EnvelopeType& type) {
+    if (std::strcmp(text, "lowpass") == 0) {
+        type = EnvelopeType::LowPass;
+    } else if (std::strcmp(text, "average") == 0) {
+        type = EnvelopeType::MovingAverage;
+    } else if (std::strcmp(text, "rms") == 0) {
+        type = EnvelopeType::MovingRms;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* envelope_type_name(EnvelopeType type) {
+    switch (type) {
+        case EnvelopeType::MovingAverage:
+            return "average";
+        case EnvelopeType::MovingRms:
+            return "rms";
+        default:
+            return "lowpass";
+    }
+}
+
+std::size_t envelope_window_samples(float sample_rate, float seconds) {
+    long samples = std::lround(sample_rate * seconds);
+    return samples > 1 ? (std::size_t)samples : 1;
+}
+
+MovingEnvelope::MovingEnvelope(EnvelopeType type, std::size_t window)
+    : rms(type == EnvelopeType::MovingRms), history(window > 0 ? window : 1),
+      inverse_window(1.0f / (window > 0 ? window : 1)) {
+    reset();
+}
+
+void MovingEnvelope::reset() {
+    std::fill(history.begin(), history.end(), 0.0f);
+    position = 0;
+    sum = 0.0f;
+    compensation = 0.0f;
+}
+
+void MovingEnvelope::process(const float* in, float* out, std::size_t n) {
+    // Copy the running state into locals so it stays in registers across the loop
+    float* window = history.data();
+    const std::size_t length = history.size();
+    std::size_t slot = position;
+    float s = sum, c = compensation;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        float value = rms ? in[i] * in[i] : std::abs(in[i]);
+        float delta = (value - window[slot]) - c;
+        float total = s + delta;
+        c = (total - s) - delta;
+        s = total;
+
+        window[slot] = value;
+        if (++slot == length) {
+            slot = 0;
+        }
+
+        float mean = s * inverse_window;
+        out[i] = !rms ? mean : (mean > 0.0f ? std::sqrt(mean) : 0.0f);
+    }
+
+    position = slot;
+    sum = s;
+    compensation = c;
+}
+
+std::size_t MovingEnvelopeBank::storage_floats(std::size_t channels, std::size_t window) {
+    return simd::round_up(channels) * ((window > 0 ? window : 1) + 2);
+}
+
+MovingEnvelopeBank::MovingEnvelopeBank(std::size_t channels, EnvelopeType type, std::size_t window, float* storage)
+    : rms(type == EnvelopeType::MovingRms), count(channels), padded(simd::round_up(channels)),
+      length(window > 0 ? window : 1), inverse_window(1.0f / (window > 0 ? window : 1)) {
+    if (!storage) {
+        owned.resize(storage_floats(channels, window));
+        storage = owned.data();
+    }
+    history = storage;
+    sums = history + padded * length;
+    compensations = sums + padded;
+    reset();
+}
+
+void MovingEnvelopeBank::reset() {
+    std::fill(history, history + padded * (length + 2), 0.0f);
+    position = 0;
+}
+
+// Run Vectors adjacent SIMD groups of channels, starting at channel first, through one block.
+// The Kahan update is a chain of dependent adds, so interleaving independent groups keeps the
+// FP pipeline busy instead of waiting on one group's latency.
+template <std::size_t Vectors>
+static void process_groups(bool rms, float inverse_window, float* history, std::size_t padded, std::size_t length,
+                           std::size_t position, float* sums, float* compensations, std::size_t first,
+                           const float* in, float* out, std::size_t frames, std::size_t stride) {
+    using namespace simd;
+
+    const vfloat inverse = set1(inverse_window);
+    const vfloat zero = set1(0.0f);
+    vfloat sum[Vectors], compensation[Vectors];
+    for (std::size_t v = 0; v < Vectors; ++v) {
+        sum[v] = load(sums + first + v * WIDTH);
+        compensation[v] = load(compensations + first + v * WIDTH);
+    }
+
+    std::size_t slot = position;
+    const float* src = in + first;
+    float* dst = out + first;
+    for (std::size_t f = 0; f < frames; ++f, src += stride, dst += stride) {
+        float* oldest = history + slot * padded + first;
+        for (std::size_t v = 0; v < Vectors; ++v) {
+            vfloat input = load(src + v * WIDTH);
+            vfloat value = rms ? mul(input, input) : abs(input);
+
+            vfloat delta = sub(sub(value, load(oldest + v * WIDTH)), compensation[v]);
+            vfloat total = add(sum[v], delta);
+            compensation[v] = sub(sub(total, sum[v]), delta);
+            sum[v] = total;
+            store(oldest + v * WIDTH, value);
+
+            vfloat mean = mul(total, inverse);
+            store(dst + v * WIDTH, rms ? simd::sqrt(max(mean, zero)) : mean);
+        }
+        if (++slot == length) {
+            slot = 0;
+        }
+    }
+
+    for (std::size_t v = 0; v < Vectors; ++v) {
+        store(sums + first + v * WIDTH, sum[v]);
+        store(compensations + first + v * WIDTH, compensation[v]);
+    }
+}
+
+void MovingEnvelopeBank::process(const float* in, float* out, std::size_t frames, std::size_t stride) {
+    using namespace simd;
+
+    // Each SIMD lane is one channel: four vectors at a time, then single vectors, and channels
+    // that don't fill a vector run scalar
+    const std::size_t vector_channels = count - count % WIDTH;
+    std::size_t c = 0;
+    for (; c + 4 * WIDTH <= vector_channels; c += 4 * WIDTH) {
+        process_groups<4>(rms, inverse_window, history, padded, length, position, sums, compensations, c, in, out,
+                          frames, stride);
+    }
+    for (; c < vector_channels; c += WIDTH) {
+        process_groups<1>(rms, inverse_window, history, padded, length, position, sums, compensations, c, in, out,
+                          frames, stride);
+    }
+
+    for (c = vector_channels; c < count; ++c) {
+        float sum = sums[c], compensation = compensations[c];
+        std::size_t slot = position;
+
+        for (std::size_t f = 0; f < frames; ++f) {
+            float input = in[f * stride + c];
+            float value = rms ? input * input : std::abs(input);
+            float& oldest = history[slot * padded + c];
+
+            float delta = (value - oldest) - compensation;
+            float total = sum + delta;
+            compensation = (total - sum) - delta;
+            sum = total;
+            oldest = value;
+            if (++slot == length) {
+                slot = 0;
+            }
+
+            float mean = sum * inverse_window;
+            out[f * stride + c] = !rms ? mean : (mean > 0.0f ? std::sqrt(mean) : 0.0f);
+        }
+
+        sums[c] = sum;
+        compensations[c] = compensation;
+    }
+
+    position = (position + frames) % length;
+}
+
+EnvelopeDetector::EnvelopeDetector(EnvelopeType type, float sample_rate, float lowpass_cutoff, float window_seconds)
+    : type(type), lowpass(FilterType::LowPass, sample_rate, lowpass_cutoff),
+      moving(type, type == EnvelopeType::LowPass ? 1 : envelope_window_samples(sample_rate, window_seconds)) {}
+
+void EnvelopeDetector::process(const float* in, float* rectified, float* envelope, std::size_t n) {
+    rectify(in, rectified, n);
+    if (type == EnvelopeType::LowPass) {
+        lowpass.process(rectified, envelope, n);
+    } else {
+        moving.process(in, envelope, n);
+    }
+}
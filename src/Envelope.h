@@ -0,0 +1,146 @@
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "Filter.h"
+
+// How the envelope is computed from the band-passed signal
+// - LowPass: Rectify, then the envelope low-pass (smooth, but slow to settle and lagging)
+// - MovingAverage: Mean of |x| over a sliding window
+// - MovingRms: Root mean square over a sliding window
+enum class EnvelopeType {
+    LowPass,
+    MovingAverage,
+    MovingRms
+};
+
+// Parse "lowpass", "average" or "rms"; returns false for anything else
+bool parse_envelope_type(const char* text, EnvelopeType& type);
+
+// Name accepted by parse_envelope_type()
+const char* envelope_type_name(EnvelopeType type);
+
+// Window length in samples for a duration, at least one sample
+std::size_t envelope_window_samples(float sample_rate, float seconds);
+
+// Sliding-window envelope with O(1) work per sample.
+// Each sample's contribution (|x| for MovingAverage, x^2 for MovingRms) is kept in a circular
+// window, and the running sum adds the new contribution and drops the oldest. The sum is
+// Kahan-compensated, so it doesn't drift however long the stream runs (build without
+// -ffast-math, which would optimize the compensation away). Until the window has filled, the
+// missing samples count as zero.
+class MovingEnvelope {
+private:
+    bool rms;
+    std::vector<float> history; // Contributions of the last window samples
+    std::size_t position; // Slot the next contribution goes in
+    float inverse_window;
+    float sum; // Running sum of the contributions
+    float compensation; // Low-order bits lost from sum
+
+public:
+    // type selects average or RMS; LowPass is treated as MovingAverage
+    MovingEnvelope(EnvelopeType type, std::size_t window);
+
+    // Empty the window
+    void reset();
+
+    std::size_t window() const { return history.size(); }
+
+    // Process a single input sample and return the envelope
+    float process(float input) {
+        float value = rms ? input * input : std::abs(input);
+
+        // Kahan step adding (new - oldest) to the running sum
+        float delta = (value - history[position]) - compensation;
+        float total = sum + delta;
+        compensation = (total - sum) - delta;
+        sum = total;
+
+        history[position] = value;
+        if (++position == history.size()) {
+            position = 0;
+        }
+
+        float mean = sum * inverse_window;
+        if (!rms) {
+            return mean;
+        }
+        // Rounding can leave a tiny negative sum once the window has emptied out
+        return mean > 0.0f ? std::sqrt(mean) : 0.0f;
+    }
+
+    // Process a block of n samples from in to out (in and out may be the same buffer);
+    // identical to calling process(float) n times
+    void process(const float* in, float* out, std::size_t n);
+};
+
+// Bank of MovingEnvelopes, one per channel, processed across channels with SIMD.
+// Samples are interleaved as [frame][channel]; every channel behaves exactly like its own
+// MovingEnvelope, and all channels advance through the window together.
+class MovingEnvelopeBank {
+private:
+    bool rms;
+    std::size_t count; // Channels
+    std::size_t padded; // Channels rounded up to whole vectors
+    std::size_t length; // Window length in frames
+    std::size_t position; // Window slot the next frame goes in
+    float inverse_window;
+    std::vector<float> owned; // Storage, unless the caller supplied it
+    float* history; // [slot][channel], padded channels per slot
+    float* sums; // Per-channel running sums
+    float* compensations; // Per-channel Kahan compensation
+
+public:
+    // Floats of storage a bank of this shape needs
+    static std::size_t storage_floats(std::size_t channels, std::size_t window);
+
+    // storage: storage_floats(channels, window) floats that outlive the bank (e.g. from an Arena),
+    // or nullptr for the bank to allocate its own
+    MovingEnvelopeBank(std::size_t channels, EnvelopeType type, std::size_t window, float* storage = nullptr);
+
+    // Moves keep the storage; copies would share it
+    MovingEnvelopeBank(const MovingEnvelopeBank&) = delete;
+    MovingEnvelopeBank& operator=(const MovingEnvelopeBank&) = delete;
+    MovingEnvelopeBank(MovingEnvelopeBank&&) = default;
+    MovingEnvelopeBank& operator=(MovingEnvelopeBank&&) = default;
+
+    void reset();
+
+    std::size_t channels() const { return count; }
+    std::size_t window() const { return length; }
+
+    // Process a block of interleaved frames from in to out (may be the same buffer)
+    void process(const float* in, float* out, std::size_t frames) { process(in, out, frames, count); }
+
+    // Process this bank's channels within wider frames of stride samples each
+    void process(const float* in, float* out, std::size_t frames, std::size_t stride);
+};
+
+// Envelope stage of the simulation's chain: takes the band-passed signal and produces the
+// rectified signal (kept for display and recording whatever the type) and the envelope
+class EnvelopeDetector {
+private:
+    EnvelopeType type;
+    PreciseFilter lowpass; // Used by LowPass
+    MovingEnvelope moving; // Used by MovingAverage and MovingRms
+
+public:
+    // - lowpass_cutoff: Envelope low-pass cutoff (Hz), for LowPass
+    // - window_seconds: Sliding window length, for MovingAverage and MovingRms
+    EnvelopeDetector(EnvelopeType type, float sample_rate, float lowpass_cutoff, float window_seconds);
+
+    EnvelopeType envelope_type() const { return type; }
+
+    // Process a block of n band-passed samples; rectified may alias in, envelope must not
+    void process(const float* in, float* rectified, float* envelope, std::size_t n);
+
+    // Envelope of one already-rectified sample, as a Pipeline stage after a Rectifier
+    float process(float rectified) {
+        return type == EnvelopeType::LowPass ? lowpass.process(rectified) : moving.process(rectified);
+    }
+};
+
+#endif // ENVELOPE_H
@@ -4,77 +4,169 @@
 #define PI 3.14159265358979323846
 
 
-Filter::Filter(FilterType type, float sample_rate, float freq1, float freq2, float q) {
-    // Initialize delay lines to zero
-    x1 = x2 = y1 = y2 = 0.0f;
+// Design in double precision; design_biquad() rounds the result to float for callers that
+// want BiquadCoefficients, double-precision filters keep it as is
+static filter_detail::Coefficients<double> design(FilterType type, double sample_rate, double freq1, double freq2, double q) {
+    double b0, b1, b2;
+    double a0, a1, a2;
 
     // Compute coefficients based on filter type
     switch (type) {
         case FilterType::HighPass: {
-            float omega = 2.0f * PI * freq1 / sample_rate;
-            float alpha = sin(omega) / (2.0f * q);
-
-            a0 = 1.0f + alpha;
-            a1 = -2.0f * cos(omega);
-            a2 = 1.0f - alpha;
-            b0 = (1.0f + cos(omega)) / 2.0f;
-            b1 = -(1.0f + cos(omega));
-            b2 = (1.0f + cos(omega)) / 2.0f;
+            double omega = 2.0 * PI * freq1 / sample_rate;
+            double alpha = std::sin(omega) / (2.0 * q);
+
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * std::cos(omega);
+            a2 = 1.0 - alpha;
+            b0 = (1.0 + std::cos(omega)) / 2.0;
+            b1 = -(1.0 + std::cos(omega));
+            b2 = (1.0 + std::cos(omega)) / 2.0;
             break;
         }
         case FilterType::BandPass: {
-            float wc = 2.0f * PI * sqrt(freq1 * freq2) / sample_rate;
-            float bw = 2.0f * PI * (freq2 - freq1) / sample_rate;
+            double wc = 2.0 * PI * std::sqrt(freq1 * freq2) / sample_rate;
+            double bw = 2.0 * PI * (freq2 - freq1) / sample_rate;
 
-            float alpha = sin(bw) * sinh(log(2.0f) / 2.0f * 1.0f * PI / 2.0f);
-            float cosw = cos(wc);
+            double alpha = std::sin(bw) * std::sinh(std::log(2.0) / 2.0 * 1.0 * PI / 2.0);
+            double cosw = std::cos(wc);
 
-            a0 = 1.0f + alpha;
-            a1 = -2.0f * cosw;
-            a2 = 1.0f - alpha;
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * cosw;
+            a2 = 1.0 - alpha;
             b0 = alpha;
-            b1 = 0.0f;
+            b1 = 0.0;
             b2 = -alpha;
             break;
         }
         case FilterType::LowPass: {
-            float omega = 2.0f * PI * freq1 / sample_rate;
-            float alpha = sin(omega) / (2.0f * q);
-
-            a0 = 1.0f + alpha;
-            a1 = -2.0f * cos(omega);
-            a2 = 1.0f - alpha;
-            b0 = (1.0f - cos(omega)) / 2.0f;
-            b1 = 1.0f - cos(omega);
-            b2 = (1.0f - cos(omega)) / 2.0f;
+            double omega = 2.0 * PI * freq1 / sample_rate;
+            double alpha = std::sin(omega) / (2.0 * q);
+
+            a0 = 1.0 + alpha;
+            a1 = -2.0 * std::cos(omega);
+            a2 = 1.0 - alpha;
+            b0 = (1.0 - std::cos(omega)) / 2.0;
+            b1 = 1.0 - std::cos(omega);
+            b2 = (1.0 - std::cos(omega)) / 2.0;
             break;
         }
         default:
-            a0 = 1.0f; a1 = a2 = b0 = b1 = b2 = 0.0f;
+            a0 = 1.0; a1 = a2 = b0 = b1 = b2 = 0.0;
             break;
     }
 
     // Normalize coefficients by dividing by a0
-    b0 /= a0;
-    b1 /= a0;
-    b2 /= a0;
-    a1 /= a0;
-    a2 /= a0;
-    a0 = 1.0f;
+    filter_detail::Coefficients<double> c;
+    c.b0 = b0 / a0;
+    c.b1 = b1 / a0;
+    c.b2 = b2 / a0;
+    c.a1 = a1 / a0;
+    c.a2 = a2 / a0;
+    return c;
+}
+
+template <typename T>
+static filter_detail::Coefficients<T> convert(const filter_detail::Coefficients<double>& d) {
+    filter_detail::Coefficients<T> c = { (T)d.b0, (T)d.b1, (T)d.b2, (T)d.a1, (T)d.a2 };
+    return c;
+}
+
+template <typename T>
+static filter_detail::Coefficients<T> convert(const BiquadCoefficients& f) {
+    filter_detail::Coefficients<T> c = { f.b0, f.b1, f.b2, f.a1, f.a2 };
+    return c;
+}
+
+BiquadCoefficients design_biquad(FilterType type, float sample_rate, float freq1, float freq2, float q) {
+    filter_detail::Coefficients<float> c = convert<float>(design(type, sample_rate, freq1, freq2, q));
+    BiquadCoefficients result = { c.b0, c.b1, c.b2, c.a1, c.a2 };
+    return result;
+}
+
+template <BiquadForm Form, typename Real>
+BasicFilter<Form, Real>::BasicFilter(FilterType type, float sample_rate, float freq1, float freq2, float q)
+    : c(convert<Real>(design(type, sample_rate, freq1, freq2, q))), type(type), sample_rate(sample_rate),
+      ramp_remaining(0) {
+    // Initialize delay lines to zero
+    state.reset();
 }
 
-float Filter::process(float input) {
-    float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+template <BiquadForm Form, typename Real>
+BiquadCoefficients BasicFilter<Form, Real>::coefficients() const {
+    BiquadCoefficients result = { (float)c.b0, (float)c.b1, (float)c.b2, (float)c.a1, (float)c.a2 };
+    return result;
+}
+
+template <BiquadForm Form, typename Real>
+void BasicFilter<Form, Real>::set_design(const Coefficients& design, std::size_t ramp_samples) {
+    if (ramp_samples == 0) {
+        c = design;
+        ramp_remaining = 0;
+        return;
+    }
 
-    // Update delay lines
-    x2 = x1;
-    x1 = input;
-    y2 = y1;
-    y1 = output;
+    // A new ramp starts from wherever the coefficients are now, even mid-ramp
+    Real inv = Real(1) / ramp_samples;
+    target = design;
+    step.b0 = (design.b0 - c.b0) * inv;
+    step.b1 = (design.b1 - c.b1) * inv;
+    step.b2 = (design.b2 - c.b2) * inv;
+    step.a1 = (design.a1 - c.a1) * inv;
+    step.a2 = (design.a2 - c.a2) * inv;
+    ramp_remaining = ramp_samples;
+}
 
-    return output;
+template <BiquadForm Form, typename Real>
+void BasicFilter<Form, Real>::set_coefficients(const BiquadCoefficients& design, std::size_t ramp_samples) {
+    set_design(convert<Real>(design), ramp_samples);
 }
 
+template <BiquadForm Form, typename Real>
+void BasicFilter<Form, Real>::retune(float freq1, float freq2, float q, std::size_t ramp_samples) {
+    set_design(convert<Real>(design(type, sample_rate, freq1, freq2, q)), ramp_samples);
+}
+
+template <BiquadForm Form, typename Real>
+void BasicFilter<Form, Real>::process(const float* in, float* out, std::size_t n) {
+    // Samples inside a coefficient ramp take the per-sample path
+    std::size_t ramped = 0;
+    while (ramp_remaining > 0 && ramped < n) {
+        out[ramped] = process(in[ramped]);
+        ++ramped;
+    }
+    in += ramped;
+    out += ramped;
+    n -= ramped;
+
+    // Copy coefficients and state into locals so they stay in registers across the loop
+    const Coefficients lc = c;
+    filter_detail::State<Form, Real> ls = state;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = (float)ls.step(lc, in[i]);
+    }
+
+    // Write the delay lines back once per block
+    state = ls;
+}
+
+template <BiquadForm Form, typename Real>
+void BasicFilter<Form, Real>::process(float* samples, std::size_t n) {
+    process(samples, samples, n);
+}
+
+template class BasicFilter<BiquadForm::DirectForm1, float>;
+template class BasicFilter<BiquadForm::DirectForm1, double>;
+template class BasicFilter<BiquadForm::TransposedDirectForm2, float>;
+template class BasicFilter<BiquadForm::TransposedDirectForm2, double>;
+
 float rectify(float input) {
     return std::abs(input);
+}
+
+void rectify(const float* in, float* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = std::abs(in[i]);
+    }
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include <cmath>
+#include <cstddef>
+
 // Enum to define filter types
 enum class FilterType {
     HighPass,
@@ -8,24 +11,167 @@ enum class FilterType {
     LowPass
 };
 
-// Filter class
-class Filter {
-private:
-    // Coefficients for the IIR difference equation
+// Normalized biquad coefficients (a0 == 1)
+struct BiquadCoefficients {
     float b0, b1, b2; // Feedforward coefficients
-    float a0, a1, a2; // Feedback coefficients
+    float a1, a2; // Feedback coefficients
+};
+
+// Compute normalized coefficients for a filter type without constructing a Filter
+BiquadCoefficients design_biquad(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f);
+
+// Difference equation layout
+// - DirectForm1: Two input and two output delay lines (four state variables)
+// - TransposedDirectForm2: Two state variables, so half the state to carry per section
+// At low cutoffs both lose accuracy in float; the fix there is double state (see BasicFilter).
+enum class BiquadForm {
+    DirectForm1,
+    TransposedDirectForm2
+};
+
+namespace filter_detail {
+
+// Coefficients at the filter's state precision
+template <typename T>
+struct Coefficients {
+    T b0, b1, b2;
+    T a1, a2;
+};
+
+// Delay lines for one topology; step() runs one sample of the difference equation
+template <BiquadForm Form, typename T>
+struct State;
+
+template <typename T>
+struct State<BiquadForm::DirectForm1, T> {
+    T x1, x2, y1, y2;
+
+    void reset() { x1 = x2 = y1 = y2 = T(0); }
+
+    T step(const Coefficients<T>& c, T input) {
+        T output = c.b0 * input + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+        x2 = x1;
+        x1 = input;
+        y2 = y1;
+        y1 = output;
+        return output;
+    }
+};
+
+template <typename T>
+struct State<BiquadForm::TransposedDirectForm2, T> {
+    T s1, s2;
+
+    void reset() { s1 = s2 = T(0); }
+
+    T step(const Coefficients<T>& c, T input) {
+        T output = c.b0 * input + s1;
+        s1 = c.b1 * input - c.a1 * output + s2;
+        s2 = c.b2 * input - c.a2 * output;
+        return output;
+    }
+};
+
+} // namespace filter_detail
 
-    // Delay lines
-    float x1, x2, y1, y2;
+// Biquad filter
+// - Form: Difference equation layout (see BiquadForm)
+// - Real: Precision of the coefficients and delay lines (float or double). Samples are
+//   always float; with double the design is also kept in double rather than rounded to
+//   BiquadCoefficients, which matters most at low cutoffs (e.g. 2 Hz at 2 kHz).
+// Use the Filter alias (DF-I, float) unless a cutoff or workload calls for something else.
+template <BiquadForm Form = BiquadForm::DirectForm1, typename Real = float>
+class BasicFilter {
+    static_assert(sizeof(Real) >= sizeof(float), "BasicFilter state must be float or double");
+
+private:
+    typedef filter_detail::Coefficients<Real> Coefficients;
+
+    Coefficients c; // Normalized coefficients for the difference equation (a0 == 1)
+    filter_detail::State<Form, Real> state; // Delay lines
+
+    // Design parameters kept for retune()
+    FilterType type;
+    float sample_rate;
+
+    // Coefficient ramp (active while ramp_remaining > 0)
+    Coefficients target; // Coefficients reached at the end of the ramp
+    Coefficients step; // Per-sample coefficient increment
+    std::size_t ramp_remaining;
+
+    // Move the coefficients one sample along the active ramp
+    void advance_ramp() {
+        if (--ramp_remaining == 0) {
+            // Land exactly on the target so rounding doesn't accumulate
+            c = target;
+            return;
+        }
+        c.b0 += step.b0;
+        c.b1 += step.b1;
+        c.b2 += step.b2;
+        c.a1 += step.a1;
+        c.a2 += step.a2;
+    }
+
+    // Set the coefficients, or start a ramp towards them
+    void set_design(const Coefficients& design, std::size_t ramp_samples);
 
 public:
-    Filter(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f);
+    BasicFilter(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f);
+
+    // Current normalized coefficients
+    BiquadCoefficients coefficients() const;
+
+    // Replace the coefficients without touching the delay lines
+    // - ramp_samples: If non-zero, interpolate linearly from the current coefficients
+    //   over this many samples instead of switching immediately
+    void set_coefficients(const BiquadCoefficients& c, std::size_t ramp_samples = 0);
+
+    // Redesign for new cutoffs with the same type and sample rate, keeping filter state
+    void retune(float freq1, float freq2 = 0.0f, float q = 1.0f, std::size_t ramp_samples = 0);
 
-    // Process a single input sample and return the output
-    float process(float input);
+    // Zero the delay lines
+    void reset() { state.reset(); }
+
+    // Process a single input sample and return the output (inline, so fused loops such as
+    // Pipeline can keep the state in registers)
+    float process(float input) {
+        if (ramp_remaining > 0) {
+            advance_ramp();
+        }
+        return (float)state.step(c, input);
+    }
+
+    // Process a block of n samples from in to out (in and out may be the same buffer)
+    // Coefficients and delay lines are held in locals for the whole block,
+    // and the output is identical to calling process(float) n times.
+    void process(const float* in, float* out, std::size_t n);
+
+    // Process a block of n samples in place
+    void process(float* samples, std::size_t n);
 };
 
+// Instantiated in Filter.cpp
+extern template class BasicFilter<BiquadForm::DirectForm1, float>;
+extern template class BasicFilter<BiquadForm::DirectForm1, double>;
+extern template class BasicFilter<BiquadForm::TransposedDirectForm2, float>;
+extern template class BasicFilter<BiquadForm::TransposedDirectForm2, double>;
+
+// The simulation's filter: Direct Form I in single precision
+typedef BasicFilter<> Filter;
+
+// Double-precision Direct Form I, for cutoffs far below the sample rate (the envelope low-pass)
+typedef BasicFilter<BiquadForm::DirectForm1, double> PreciseFilter;
+
 // Rectifier (absolute value)
 float rectify(float input);
 
+// Rectifier as a stage for Pipeline
+struct Rectifier {
+    float process(float input) const { return std::abs(input); }
+};
+
+// Rectify a block of n samples from in to out (in and out may be the same buffer)
+void rectify(const float* in, float* out, std::size_t n);
+
 #endif // FILTER_H
\ No newline at end of file
@@ -0,0 +1,309 @@
+#ifndef FILTER_BANK_H
+#define FILTER_BANK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "Filter.h"
+#include "Simd.h"
+
+// Channel count that selects the runtime-sized FilterBank specialization
+const std::size_t DYNAMIC_CHANNELS = 0;
+
+namespace filterbank_detail {
+
+// Structure-of-arrays view of a bank: one array per coefficient/delay line, indexed by channel
+struct Lanes {
+    float* b0;
+    float* b1;
+    float* b2;
+    float* a1;
+    float* a2;
+    float* x1;
+    float* x2;
+    float* y1;
+    float* y2;
+};
+
+// Run the Direct Form I difference equation over interleaved frames.
+// in/out point at the bank's first channel in frames laid out as [frame][channel], with
+// stride samples between frames (stride >= channels, so a bank can cover part of a wider
+// frame); they may alias. Each SIMD lane is one channel; a group's coefficients and state
+// stay in registers for the whole block. Channels that don't fill a vector run scalar.
+inline void process(const Lanes& l, std::size_t channels, const float* in, float* out, std::size_t frames,
+                    std::size_t stride) {
+    using namespace simd;
+
+    const std::size_t vector_channels = channels - channels % WIDTH;
+    for (std::size_t c = 0; c < vector_channels; c += WIDTH) {
+        const vfloat b0 = load(l.b0 + c), b1 = load(l.b1 + c), b2 = load(l.b2 + c);
+        const vfloat a1 = load(l.a1 + c), a2 = load(l.a2 + c);
+        vfloat x1 = load(l.x1 + c), x2 = load(l.x2 + c);
+        vfloat y1 = load(l.y1 + c), y2 = load(l.y2 + c);
+
+        const float* src = in + c;
+        float* dst = out + c;
+        for (std::size_t f = 0; f < frames; ++f, src += stride, dst += stride) {
+            vfloat input = load(src);
+            vfloat output = sub(sub(add(add(mul(b0, input), mul(b1, x1)), mul(b2, x2)), mul(a1, y1)), mul(a2, y2));
+
+            x2 = x1;
+            x1 = input;
+            y2 = y1;
+            y1 = output;
+
+            store(dst, output);
+        }
+
+        store(l.x1 + c, x1);
+        store(l.x2 + c, x2);
+        store(l.y1 + c, y1);
+        store(l.y2 + c, y2);
+    }
+
+    for (std::size_t c = vector_channels; c < channels; ++c) {
+        const float b0 = l.b0[c], b1 = l.b1[c], b2 = l.b2[c];
+        const float a1 = l.a1[c], a2 = l.a2[c];
+        float x1 = l.x1[c], x2 = l.x2[c], y1 = l.y1[c], y2 = l.y2[c];
+
+        for (std::size_t f = 0; f < frames; ++f) {
+            float input = in[f * stride + c];
+            float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+
+            x2 = x1;
+            x1 = input;
+            y2 = y1;
+            y1 = output;
+
+            out[f * stride + c] = output;
+        }
+
+        l.x1[c] = x1;
+        l.x2[c] = x2;
+        l.y1[c] = y1;
+        l.y2[c] = y2;
+    }
+}
+
+inline void set_coefficients(const Lanes& l, std::size_t channel, const BiquadCoefficients& c) {
+    l.b0[channel] = c.b0;
+    l.b1[channel] = c.b1;
+    l.b2[channel] = c.b2;
+    l.a1[channel] = c.a1;
+    l.a2[channel] = c.a2;
+}
+
+inline void reset(const Lanes& l, std::size_t channels) {
+    for (std::size_t c = 0; c < channels; ++c) {
+        l.x1[c] = l.x2[c] = l.y1[c] = l.y2[c] = 0.0f;
+    }
+}
+
+} // namespace filterbank_detail
+
+// Bank of independent biquads, one per channel, processed across channels with SIMD
+// - Channels: Compile-time channel count, or DYNAMIC_CHANNELS to size the bank at runtime
+// Samples are interleaved as [frame][channel]. Every channel behaves exactly like its own Filter.
+template <std::size_t Channels = DYNAMIC_CHANNELS>
+class FilterBank {
+private:
+    static constexpr std::size_t PADDED = simd::round_up(Channels);
+
+    alignas(64) float b0[PADDED], b1[PADDED], b2[PADDED];
+    alignas(64) float a1[PADDED], a2[PADDED];
+    alignas(64) float x1[PADDED], x2[PADDED], y1[PADDED], y2[PADDED];
+
+    filterbank_detail::Lanes lanes() {
+        filterbank_detail::Lanes l = { b0, b1, b2, a1, a2, x1, x2, y1, y2 };
+        return l;
+    }
+
+public:
+    // All channels share one design
+    FilterBank(FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f)
+        : FilterBank(design_biquad(type, sample_rate, freq1, freq2, q)) {}
+
+    explicit FilterBank(const BiquadCoefficients& c) {
+        set_coefficients(c);
+        reset();
+    }
+
+    // Set coefficients for every channel, or for one channel
+    void set_coefficients(const BiquadCoefficients& c) {
+        for (std::size_t ch = 0; ch < Channels; ++ch) {
+            filterbank_detail::set_coefficients(lanes(), ch, c);
+        }
+    }
+    void set_coefficients(std::size_t channel, const BiquadCoefficients& c) {
+        filterbank_detail::set_coefficients(lanes(), channel, c);
+    }
+
+    // Zero every channel's delay lines
+    void reset() { filterbank_detail::reset(lanes(), Channels); }
+
+    static constexpr std::size_t channels() { return Channels; }
+
+    // Process a block of interleaved frames from in to out (may be the same buffer)
+    void process(const float* in, float* out, std::size_t frames) {
+        filterbank_detail::process(lanes(), Channels, in, out, frames, Channels);
+    }
+
+    // Process this bank's channels within wider frames of stride samples each
+    void process(const float* in, float* out, std::size_t frames, std::size_t stride) {
+        filterbank_detail::process(lanes(), Channels, in, out, frames, stride);
+    }
+
+    // Process a block of interleaved frames in place
+    void process(float* samples, std::size_t frames) { process(samples, samples, frames); }
+};
+
+// Runtime-sized fallback for channel counts only known at startup
+template <>
+class FilterBank<DYNAMIC_CHANNELS> {
+private:
+    std::size_t count;
+    std::size_t padded;
+    std::vector<float> storage; // Nine lane arrays of `padded` floats each
+
+    filterbank_detail::Lanes lanes() {
+        float* p = storage.data();
+        filterbank_detail::Lanes l = {
+            p, p + padded, p + 2 * padded, p + 3 * padded, p + 4 * padded,
+            p + 5 * padded, p + 6 * padded, p + 7 * padded, p + 8 * padded
+        };
+        return l;
+    }
+
+public:
+    FilterBank(std::size_t channels, FilterType type, float sample_rate, float freq1, float freq2 = 0.0f, float q = 1.0f)
+        : FilterBank(channels, design_biquad(type, sample_rate, freq1, freq2, q)) {}
+
+    FilterBank(std::size_t channels, const BiquadCoefficients& c)
+        : count(channels), padded(simd::round_up(channels)), storage(9 * simd::round_up(channels), 0.0f) {
+        set_coefficients(c);
+    }
+
+    void set_coefficients(const BiquadCoefficients& c) {
+        for (std::size_t ch = 0; ch < count; ++ch) {
+            filterbank_detail::set_coefficients(lanes(), ch, c);
+        }
+    }
+    void set_coefficients(std::size_t channel, const BiquadCoefficients& c) {
+        filterbank_detail::set_coefficients(lanes(), channel, c);
+    }
+
+    void reset() { filterbank_detail::reset(lanes(), count); }
+
+    std::size_t channels() const { return count; }
+
+    void process(const float* in, float* out, std::size_t frames) {
+        filterbank_detail::process(lanes(), count, in, out, frames, count);
+    }
+
+    void process(const float* in, float* out, std::size_t frames, std::size_t stride) {
+        filterbank_detail::process(lanes(), count, in, out, frames, stride);
+    }
+
+    void process(float* samples, std::size_t frames) { process(samples, samples, frames); }
+};
+
+// Runtime-sized bank over lane storage it doesn't own, such as a block carved from an Arena,
+// so the lanes can sit next to the rest of a session's channel state. Processes exactly like
+// FilterBank<DYNAMIC_CHANNELS>, and adds Filter's coefficient ramps so retuning every channel
+// doesn't click. Trivially copyable: copies are views of the same lanes.
+class FilterBankView {
+private:
+    filterbank_detail::Lanes l;
+    float* steps; // Ramp increments: b0, b1, b2, a1 and a2 lanes of padded floats each
+    std::size_t count;
+    std::size_t padded;
+    BiquadCoefficients target; // Where every channel's ramp ends
+    std::size_t ramp_remaining;
+
+    // Move every channel's coefficients one sample along the active ramp
+    void advance_ramp() {
+        if (--ramp_remaining == 0) {
+            // Land exactly on the target so rounding doesn't accumulate
+            for (std::size_t ch = 0; ch < count; ++ch) {
+                filterbank_detail::set_coefficients(l, ch, target);
+            }
+            return;
+        }
+        for (std::size_t ch = 0; ch < count; ++ch) {
+            l.b0[ch] += steps[ch];
+            l.b1[ch] += steps[padded + ch];
+            l.b2[ch] += steps[2 * padded + ch];
+            l.a1[ch] += steps[3 * padded + ch];
+            l.a2[ch] += steps[4 * padded + ch];
+        }
+    }
+
+public:
+    // Floats of storage a bank of this many channels needs
+    static std::size_t storage_floats(std::size_t channels) { return 14 * simd::round_up(channels); }
+
+    FilterBankView() : l(), steps(nullptr), count(0), padded(0), target(), ramp_remaining(0) {}
+
+    // storage: storage_floats(channels) floats, laid out as the nine Lanes arrays then the ramp
+    // increments; every channel starts with coefficients c and zeroed delay lines
+    FilterBankView(std::size_t channels, const BiquadCoefficients& c, float* storage)
+        : steps(storage + 9 * simd::round_up(channels)), count(channels), padded(simd::round_up(channels)),
+          target(c), ramp_remaining(0) {
+        float* p = storage;
+        filterbank_detail::Lanes lanes = {
+            p, p + padded, p + 2 * padded, p + 3 * padded, p + 4 * padded,
+            p + 5 * padded, p + 6 * padded, p + 7 * padded, p + 8 * padded
+        };
+        l = lanes;
+        std::fill(storage, storage + storage_floats(channels), 0.0f);
+        set_coefficients(c);
+    }
+
+    // Set every channel's coefficients without touching the delay lines
+    // - ramp_samples: If non-zero, interpolate linearly from each channel's current coefficients
+    //   over this many samples instead of switching immediately
+    void set_coefficients(const BiquadCoefficients& c, std::size_t ramp_samples = 0) {
+        target = c;
+        if (ramp_samples == 0) {
+            for (std::size_t ch = 0; ch < count; ++ch) {
+                filterbank_detail::set_coefficients(l, ch, c);
+            }
+            ramp_remaining = 0;
+            return;
+        }
+        // A new ramp starts from wherever the coefficients are now, even mid-ramp
+        float inv = 1.0f / ramp_samples;
+        for (std::size_t ch = 0; ch < count; ++ch) {
+            steps[ch] = (c.b0 - l.b0[ch]) * inv;
+            steps[padded + ch] = (c.b1 - l.b1[ch]) * inv;
+            steps[2 * padded + ch] = (c.b2 - l.b2[ch]) * inv;
+            steps[3 * padded + ch] = (c.a1 - l.a1[ch]) * inv;
+            steps[4 * padded + ch] = (c.a2 - l.a2[ch]) * inv;
+        }
+        ramp_remaining = ramp_samples;
+    }
+
+    void reset() { filterbank_detail::reset(l, count); }
+
+    std::size_t channels() const { return count; }
+
+    // The structure-of-arrays layout this view works on
+    const filterbank_detail::Lanes& lanes() const { return l; }
+
+    // Process this bank's channels within frames of stride samples each (in and out may alias).
+    // Frames under a ramp run one at a time with the coefficients they'd have in a Filter.
+    void process(const float* in, float* out, std::size_t frames, std::size_t stride) {
+        std::size_t f = 0;
+        for (; ramp_remaining > 0 && f < frames; ++f) {
+            advance_ramp();
+            filterbank_detail::process(l, count, in + f * stride, out + f * stride, 1, stride);
+        }
+        if (f < frames) {
+            filterbank_detail::process(l, count, in + f * stride, out + f * stride, frames - f, stride);
+        }
+    }
+
+    void process(const float* in, float* out, std::size_t frames) { process(in, out, frames, count); }
+};
+
+#endif // FILTER_BANK_H
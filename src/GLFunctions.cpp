@@ -0,0 +1,135 @@
+#include "GLFunctions.h"
+#include "Logger.h"
+
+namespace gl {
+
+PFNGLGENBUFFERSPROC GenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC DeleteBuffers = nullptr;
+PFNGLBINDBUFFERPROC BindBuffer = nullptr;
+PFNGLBUFFERDATAPROC BufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC BufferSubData = nullptr;
+
+PFNGLCREATESHADERPROC CreateShader = nullptr;
+PFNGLDELETESHADERPROC DeleteShader = nullptr;
+PFNGLSHADERSOURCEPROC ShaderSource = nullptr;
+PFNGLCOMPILESHADERPROC CompileShader = nullptr;
+PFNGLGETSHADERIVPROC GetShaderiv = nullptr;
+PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog = nullptr;
+PFNGLCREATEPROGRAMPROC CreateProgram = nullptr;
+PFNGLDELETEPROGRAMPROC DeleteProgram = nullptr;
+PFNGLATTACHSHADERPROC AttachShader = nullptr;
+PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation = nullptr;
+PFNGLLINKPROGRAMPROC LinkProgram = nullptr;
+PFNGLGETPROGRAMIVPROC GetProgramiv = nullptr;
+PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog = nullptr;
+PFNGLUSEPROGRAMPROC UseProgram = nullptr;
+PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation = nullptr;
+PFNGLUNIFORM1FPROC Uniform1f = nullptr;
+PFNGLUNIFORM3FPROC Uniform3f = nullptr;
+PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer = nullptr;
+PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray = nullptr;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray = nullptr;
+
+// Look up one entry point, reporting it by name if the driver doesn't provide it
+template <typename T>
+static bool load(T& function, const char* name) {
+    function = (T)glfwGetProcAddress(name);
+    if (!function) {
+        LOG_ERROR("Missing OpenGL function: %s", name);
+        return false;
+    }
+    return true;
+}
+
+bool load_functions() {
+    bool ok = true;
+    ok &= load(GenBuffers, "glGenBuffers");
+    ok &= load(DeleteBuffers, "glDeleteBuffers");
+    ok &= load(BindBuffer, "glBindBuffer");
+    ok &= load(BufferData, "glBufferData");
+    ok &= load(BufferSubData, "glBufferSubData");
+
+    ok &= load(CreateShader, "glCreateShader");
+    ok &= load(DeleteShader, "glDeleteShader");
+    ok &= load(ShaderSource, "glShaderSource");
+    ok &= load(CompileShader, "glCompileShader");
+    ok &= load(GetShaderiv, "glGetShaderiv");
+    ok &= load(GetShaderInfoLog, "glGetShaderInfoLog");
+    ok &= load(CreateProgram, "glCreateProgram");
+    ok &= load(DeleteProgram, "glDeleteProgram");
+    ok &= load(AttachShader, "glAttachShader");
+    ok &= load(BindAttribLocation, "glBindAttribLocation");
+    ok &= load(LinkProgram, "glLinkProgram");
+    ok &= load(GetProgramiv, "glGetProgramiv");
+    ok &= load(GetProgramInfoLog, "glGetProgramInfoLog");
+    ok &= load(UseProgram, "glUseProgram");
+    ok &= load(GetUniformLocation, "glGetUniformLocation");
+    ok &= load(Uniform1f, "glUniform1f");
+    ok &= load(Uniform3f, "glUniform3f");
+    ok &= load(VertexAttribPointer, "glVertexAttribPointer");
+    ok &= load(EnableVertexAttribArray, "glEnableVertexAttribArray");
+    ok &= load(DisableVertexAttribArray, "glDisableVertexAttribArray");
+    return ok;
+}
+
+// Compile one shader stage; returns 0 and logs the compiler output on failure
+static GLuint compile_shader(GLenum stage, const char* source) {
+    GLuint shader = CreateShader(stage);
+    ShaderSource(shader, 1, &source, nullptr);
+    CompileShader(shader);
+
+    GLint status = GL_FALSE;
+    GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        GetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        LOG_ERROR("Shader compilation failed: %s", log);
+        DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint build_program(const char* vertex_source, const char* fragment_source, const char* const* attributes) {
+    GLuint vertex = compile_shader(GL_VERTEX_SHADER, vertex_source);
+    if (!vertex) {
+        return 0;
+    }
+    GLuint fragment = compile_shader(GL_FRAGMENT_SHADER, fragment_source);
+    if (!fragment) {
+        DeleteShader(vertex);
+        return 0;
+    }
+
+    GLuint program = CreateProgram();
+    AttachShader(program, vertex);
+    AttachShader(program, fragment);
+    for (GLuint location = 0; attributes && attributes[location]; ++location) {
+        BindAttribLocation(program, location, attributes[location]);
+    }
+    LinkProgram(program);
+
+    // The program keeps the compiled stages alive; the shader objects can go
+    DeleteShader(vertex);
+    DeleteShader(fragment);
+
+    GLint status = GL_FALSE;
+    GetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        GetProgramInfoLog(program, sizeof(log), nullptr, log);
+        LOG_ERROR("Shader program link failed: %s", log);
+        DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+} // namespace gl
+
+void check_gl_error(const char* operation) {
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR) {
+        LOG_EVERY(1000, LogLevel::Error, "OpenGL Error after %s: %u", operation, (unsigned)error);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef GL_FUNCTIONS_H
+#define GL_FUNCTIONS_H
+
+// Include this instead of <GLFW/glfw3.h> so the extension typedefs come along
+#define GLFW_INCLUDE_GLEXT
+#include <GLFW/glfw3.h>
+
+// OpenGL entry points newer than 1.1. opengl32.dll on Windows only exports 1.1,
+// so everything past that is looked up through glfwGetProcAddress at startup.
+namespace gl {
+
+extern PFNGLGENBUFFERSPROC GenBuffers;
+extern PFNGLDELETEBUFFERSPROC DeleteBuffers;
+extern PFNGLBINDBUFFERPROC BindBuffer;
+extern PFNGLBUFFERDATAPROC BufferData;
+extern PFNGLBUFFERSUBDATAPROC BufferSubData;
+
+extern PFNGLCREATESHADERPROC CreateShader;
+extern PFNGLDELETESHADERPROC DeleteShader;
+extern PFNGLSHADERSOURCEPROC ShaderSource;
+extern PFNGLCOMPILESHADERPROC CompileShader;
+extern PFNGLGETSHADERIVPROC GetShaderiv;
+extern PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+extern PFNGLCREATEPROGRAMPROC CreateProgram;
+extern PFNGLDELETEPROGRAMPROC DeleteProgram;
+extern PFNGLATTACHSHADERPROC AttachShader;
+extern PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+extern PFNGLLINKPROGRAMPROC LinkProgram;
+extern PFNGLGETPROGRAMIVPROC GetProgramiv;
+extern PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+extern PFNGLUSEPROGRAMPROC UseProgram;
+extern PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+extern PFNGLUNIFORM1FPROC Uniform1f;
+extern PFNGLUNIFORM3FPROC Uniform3f;
+extern PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+
+// Resolve every entry point for the current context; returns false if any is missing
+bool load_functions();
+
+// Compile and link a vertex/fragment shader pair; returns 0 and logs the error on failure
+// - attributes: Names bound to attribute locations 0, 1, ... in order (nullptr-terminated)
+GLuint build_program(const char* vertex_source, const char* fragment_source, const char* const* attributes);
+
+} // namespace gl
+
+// Check for OpenGL errors after a specific operation
+void check_gl_error(const char* operation);
+
+// glGetError stalls the pipeline on many drivers, so checks only run in debug builds
+#ifdef NDEBUG
+#define GL_CHECK(operation) ((void)0)
+#else
+#define GL_CHECK(operation) check_gl_error(operation)
+#endif
+
+#endif // GL_FUNCTIONS_H
@@ -0,0 +1,83 @@
+#include "Latency.h"
+#include "Logger.h"
+#include <chrono>
+
+std::int64_t latency_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), largest(0) {
+    for (std::atomic<std::uint64_t>& bucket : counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return (std::size_t)value;
+    }
+    if (value >> MAX_MAGNITUDE) {
+        return BUCKETS - 1;
+    }
+    // Index of the highest set bit, by binary search
+    unsigned magnitude = 0;
+    for (unsigned step = 32; step > 0; step >>= 1) {
+        if (value >> (magnitude + step)) {
+            magnitude += step;
+        }
+    }
+    // The top SUB_BUCKET_BITS + 1 bits pick the bucket within the magnitude's octave
+    unsigned shift = magnitude - SUB_BUCKET_BITS;
+    return shift * SUB_BUCKETS + (std::size_t)(value >> shift);
+}
+
+std::uint64_t LatencyHistogram::bucket_upper(std::size_t index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    std::size_t shift = index / SUB_BUCKETS - 1;
+    std::uint64_t top = index - shift * SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+double LatencyHistogram::mean() const {
+    std::uint64_t n = count();
+    return n > 0 ? (double)sum.load(std::memory_order_relaxed) / n : 0.0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const {
+    // Sum the buckets first: a concurrent record() may land between reading total and the buckets
+    std::uint64_t n = 0;
+    for (const std::atomic<std::uint64_t>& bucket : counts) {
+        n += bucket.load(std::memory_order_relaxed);
+    }
+    if (n == 0) {
+        return 0;
+    }
+    std::uint64_t rank = (std::uint64_t)(fraction * n + 0.5);
+    rank = rank < 1 ? 1 : (rank > n ? n : rank);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            std::uint64_t upper = bucket_upper(i);
+            std::uint64_t high = max();
+            return upper < high ? upper : high;
+        }
+    }
+    return max();
+}
+
+void log_latency_report(const LatencyStage* stages, std::size_t count) {
+    LOG_INFO("Latency (us):       count       mean        p50        p99      p99.9        max");
+    for (std::size_t i = 0; i < count; ++i) {
+        const LatencyHistogram& h = stages[i].histogram;
+        if (h.count() == 0) {
+            continue;
+        }
+        LOG_INFO("  %-14s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f", stages[i].name, (unsigned long long)h.count(),
+                 h.mean() / 1000.0, h.percentile(0.5) / 1000.0, h.percentile(0.99) / 1000.0,
+                 h.percentile(0.999) / 1000.0, h.max() / 1000.0);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Monotonic timestamp in nanoseconds (steady_clock)
+std::int64_t latency_now();
+
+// HDR-style latency histogram: every power of two is split into SUB_BUCKETS linear buckets,
+// so any recorded value is known to within 1/SUB_BUCKETS (about 1.6%) from 1 ns up to
+// about 18 minutes, in a fixed table with no allocation.
+// Lock-free with one writer: only one thread may record(), but any thread may read the counts
+// at any time (a reader sees each bucket either before or after a concurrent record).
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 6;
+    static constexpr std::size_t SUB_BUCKETS = (std::size_t)1 << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_MAGNITUDE = 40; // Values from 2^40 ns (~18 min) up share the top bucket
+    static constexpr std::size_t BUCKETS = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+
+    void record(std::int64_t nanoseconds) {
+        std::uint64_t value = nanoseconds > 0 ? (std::uint64_t)nanoseconds : 0;
+        std::atomic<std::uint64_t>& bucket = counts[bucket_index(value)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value > largest.load(std::memory_order_relaxed)) {
+            largest.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::uint64_t max() const { return largest.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Smallest value (ns) at or above the given fraction (0..1) of the recorded values, e.g.
+    // 0.999 for p99.9; rounded up to its bucket's upper edge, so never an underestimate.
+    // 0 if nothing has been recorded.
+    std::uint64_t percentile(double fraction) const;
+
+    // Bucket a value falls in, and the largest value in a bucket
+    static std::size_t bucket_index(std::uint64_t value);
+    static std::uint64_t bucket_upper(std::size_t index);
+
+private:
+    std::atomic<std::uint64_t> counts[BUCKETS];
+    std::atomic<std::uint64_t> total;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> largest;
+};
+
+// Records the time from construction to destruction (or stop()) into a histogram
+class ScopedTimer {
+private:
+    LatencyHistogram* histogram; // nullptr once stopped
+    std::int64_t start;
+
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram) : histogram(&histogram), start(latency_now()) {}
+    ~ScopedTimer() { stop(); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    // Record now rather than at the end of the scope
+    void stop() {
+        if (histogram) {
+            histogram->record(latency_now() - start);
+            histogram = nullptr;
+        }
+    }
+};
+
+// A named histogram, for reporting a set of them together; tables of them are written
+// { "name" }, ... (not explicit, so each entry converts from its name)
+struct LatencyStage {
+    const char* name;
+    LatencyHistogram histogram;
+
+    LatencyStage(const char* name) : name(name), histogram() {}
+};
+
+// Log one line per stage with at least one sample: count, mean, p50, p99, p99.9 and max
+void log_latency_report(const LatencyStage* stages, std::size_t count);
+
+#endif // LATENCY_H
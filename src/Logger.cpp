@@ -0,0 +1,153 @@
+#include "Logger.h"
+#include "MpscRing.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+
+const std::size_t LOG_QUEUE_CAPACITY = 1024; // Queued messages before new ones are dropped
+const std::size_t LOG_MESSAGE_SIZE = 240; // Bytes of formatted text per message (longer text is truncated)
+const auto LOG_DRAIN_INTERVAL = std::chrono::milliseconds(5); // Writer thread polling period
+
+struct LogRecord {
+    LogLevel level;
+    char text[LOG_MESSAGE_SIZE];
+};
+
+static MpscRing<LogRecord, LOG_QUEUE_CAPACITY> log_queue;
+static std::atomic<int> minimum_level{(int)LogLevel::Info};
+static std::atomic<unsigned long> dropped_messages{0};
+static std::atomic<bool> writer_running{false};
+static std::atomic<bool> draining{false}; // Held by whichever thread is the ring's one consumer
+static std::thread writer_thread;
+
+static std::int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* level_prefix(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "[debug] ";
+        case LogLevel::Warning: return "Warning: ";
+        case LogLevel::Error: return "Error: ";
+        default: return "";
+    }
+}
+
+// Write everything currently queued; returns true if anything was written
+static bool drain() {
+    LogRecord record;
+    bool wrote = false;
+    while (log_queue.try_pop(record)) {
+        FILE* stream = record.level >= LogLevel::Warning ? stderr : stdout;
+        std::fputs(level_prefix(record.level), stream);
+        std::fputs(record.text, stream);
+        std::fputc('\n', stream);
+        wrote = true;
+    }
+
+    unsigned long dropped = dropped_messages.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        std::fprintf(stderr, "Warning: log queue full, %lu messages dropped\n", dropped);
+        wrote = true;
+    }
+
+    // One flush per batch instead of one per line
+    if (wrote) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+    return wrote;
+}
+
+// drain() as the ring's only consumer: the writer thread and producers writing synchronously
+// (before start, after stop, or while the two race) take turns, never popping at once
+static void drain_exclusive() {
+    while (draining.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    drain();
+    draining.store(false, std::memory_order_release);
+}
+
+static void writer_loop() {
+    while (writer_running.load(std::memory_order_acquire)) {
+        drain_exclusive();
+        std::this_thread::sleep_for(LOG_DRAIN_INTERVAL);
+    }
+    drain_exclusive();
+}
+
+void logger_start() {
+    if (writer_running.exchange(true)) {
+        return;
+    }
+    writer_thread = std::thread(writer_loop);
+}
+
+void logger_stop() {
+    if (!writer_running.exchange(false)) {
+        return;
+    }
+    writer_thread.join();
+}
+
+void set_log_level(LogLevel level) {
+    minimum_level.store((int)level, std::memory_order_relaxed);
+}
+
+// Format and enqueue; suppressed > 0 appends how many rate-limited messages were skipped
+static void enqueue(LogLevel level, unsigned long suppressed, const char* format, va_list args) {
+    LogRecord record;
+    record.level = level;
+    int length = std::vsnprintf(record.text, sizeof(record.text), format, args);
+    if (suppressed > 0 && length >= 0 && (std::size_t)length < sizeof(record.text)) {
+        std::snprintf(record.text + length, sizeof(record.text) - length, " (%lu similar suppressed)", suppressed);
+    }
+
+    if (!log_queue.try_push(record)) {
+        dropped_messages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Before logger_start (or after logger_stop) there is no writer, so write synchronously
+    if (!writer_running.load(std::memory_order_acquire)) {
+        drain_exclusive();
+    }
+}
+
+void log_message(LogLevel level, const char* format, ...) {
+    if ((int)level < minimum_level.load(std::memory_order_relaxed)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    enqueue(level, 0, format, args);
+    va_end(args);
+}
+
+void log_limited(LogRateLimiter& limiter, LogLevel level, const char* format, ...) {
+    if ((int)level < minimum_level.load(std::memory_order_relaxed)) {
+        return;
+    }
+    unsigned long suppressed;
+    if (!limiter.allow(suppressed)) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    enqueue(level, suppressed, format, args);
+    va_end(args);
+}
+
+bool LogRateLimiter::allow(unsigned long& suppressed_count) {
+    std::int64_t now = now_us();
+    std::int64_t next = next_allowed_us.load(std::memory_order_relaxed);
+    // Only one thread wins the slot for this interval; the rest count as suppressed
+    if (now < next || !next_allowed_us.compare_exchange_strong(next, now + interval_us, std::memory_order_relaxed)) {
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed_count = suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+}
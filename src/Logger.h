@@ -0,0 +1,74 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Asynchronous console logging. Callers format into a fixed-size record and push it onto a
+// lock-free queue; a background thread does all console I/O. Logging never blocks and never
+// allocates: if the queue is full the message is dropped and counted instead.
+
+enum class LogLevel {
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Per-call-site rate limiter; at most one message per interval gets through,
+// and the next one that does reports how many were suppressed in between
+class LogRateLimiter {
+private:
+    std::int64_t interval_us;
+    std::atomic<std::int64_t> next_allowed_us{0};
+    std::atomic<unsigned long> suppressed{0};
+
+public:
+    explicit LogRateLimiter(std::int64_t interval_ms) : interval_us(interval_ms * 1000) {}
+
+    // Returns true if a message may be logged now; suppressed_count receives the number skipped since the last one
+    bool allow(unsigned long& suppressed_count);
+};
+
+// Start the background writer thread (call once, before any threads log)
+void logger_start();
+
+// Drain every queued message and stop the writer thread
+void logger_stop();
+
+// Messages below this level are discarded at the call site
+void set_log_level(LogLevel level);
+
+// Queue a printf-style message
+void log_message(LogLevel level, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+// Queue a printf-style message through a rate limiter
+void log_limited(LogRateLimiter& limiter, LogLevel level, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+#define LOG_DEBUG(...) log_message(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) log_message(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) log_message(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) log_message(LogLevel::Error, __VA_ARGS__)
+
+// Log at most once per interval_ms from this call site
+#define LOG_EVERY(interval_ms, level, ...)                          \
+    do {                                                            \
+        static LogRateLimiter log_call_site_limiter(interval_ms);   \
+        log_limited(log_call_site_limiter, level, __VA_ARGS__);     \
+    } while (0)
+
+// Starts the logger for the lifetime of a scope and flushes it on every exit path
+struct LoggerSession {
+    LoggerSession() { logger_start(); }
+    ~LoggerSession() { logger_stop(); }
+};
+
+#endif // LOGGER_H
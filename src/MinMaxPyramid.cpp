@@ -0,0 +1,105 @@
+#include "MinMaxPyramid.h"
+#include <algorithm>
+#include <limits>
+
+// Smallest power of two holding capacity samples
+static std::size_t ring_length(std::size_t capacity) {
+    std::size_t length = 1;
+    while (length < capacity) {
+        length <<= 1;
+    }
+    return length;
+}
+
+std::size_t MinMaxPyramid::storage_floats(std::size_t capacity) {
+    // The raw ring, then length - 1 runs over all the levels above it for each of minima and maxima
+    return 3 * ring_length(capacity) - 2;
+}
+
+MinMaxPyramid::MinMaxPyramid(std::size_t capacity, float* storage) : length(ring_length(capacity)), levels(1) {
+    while (((std::size_t)1 << (levels - 1)) < length) {
+        ++levels;
+    }
+    if (!storage) {
+        owned.resize(storage_floats(capacity));
+        storage = owned.data();
+    }
+    values = storage;
+    minima = values + length;
+    maxima = minima + (length - 1);
+    reset();
+}
+
+void MinMaxPyramid::reset() {
+    std::fill(values, values + 3 * length - 2, 0.0f);
+    written = length;
+}
+
+void MinMaxPyramid::push(float value) {
+    const std::uint64_t n = written++;
+    values[n & (length - 1)] = value;
+
+    // The sample completes a run at every level whose run length divides n + 1; each of those
+    // is the min/max of its two halves one level down
+    for (std::size_t level = 1; level < levels && ((n + 1) & (((std::uint64_t)1 << level) - 1)) == 0; ++level) {
+        const std::uint64_t left = (n >> level) << 1; // First half's run index one level down
+        float low, high;
+        if (level == 1) {
+            float a = values[left & (length - 1)];
+            float b = values[(left + 1) & (length - 1)];
+            low = std::min(a, b);
+            high = std::max(a, b);
+        } else {
+            const std::size_t mask = (length >> (level - 1)) - 1;
+            const std::size_t a = offset(level - 1) + (left & mask);
+            const std::size_t b = offset(level - 1) + ((left + 1) & mask);
+            low = std::min(minima[a], minima[b]);
+            high = std::max(maxima[a], maxima[b]);
+        }
+        const std::size_t slot = offset(level) + ((n >> level) & ((length >> level) - 1));
+        minima[slot] = low;
+        maxima[slot] = high;
+    }
+}
+
+void MinMaxPyramid::range(std::uint64_t first, std::uint64_t last, float& low, float& high) const {
+    low = std::numeric_limits<float>::infinity();
+    high = -std::numeric_limits<float>::infinity();
+    // Take the largest aligned run that starts at first and ends by last, each time. first stays
+    // aligned to the current level after every run, so the level only needs adjusting, never a
+    // search from 0: it climbs while runs fit and then falls towards last.
+    std::size_t level = 0;
+    while (first < last) {
+        while (level + 1 < levels && (first & (((std::uint64_t)2 << level) - 1)) == 0 &&
+               first + ((std::uint64_t)2 << level) <= last) {
+            ++level;
+        }
+        while (first + ((std::uint64_t)1 << level) > last) {
+            --level;
+        }
+
+        if (level == 0) {
+            float value = values[first & (length - 1)];
+            low = std::min(low, value);
+            high = std::max(high, value);
+        } else {
+            const std::size_t slot = offset(level) + ((first >> level) & ((length >> level) - 1));
+            low = std::min(low, minima[slot]);
+            high = std::max(high, maxima[slot]);
+        }
+        first += (std::uint64_t)1 << level;
+    }
+}
+
+void MinMaxPyramid::decimate(std::size_t count, std::size_t columns, float* out) const {
+    const std::uint64_t start = written - count;
+    for (std::size_t c = 0; c < columns; ++c) {
+        std::uint64_t first = start + (std::uint64_t)c * count / columns;
+        std::uint64_t last = start + (std::uint64_t)(c + 1) * count / columns;
+        if (last <= first) {
+            first = std::min(first, written - 1);
+            last = first + 1;
+        }
+        range(first, last, out[2 * c], out[2 * c + 1]);
+    }
+}
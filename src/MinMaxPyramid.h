@@ -0,0 +1,58 @@
+#ifndef MIN_MAX_PYRAMID_H
+#define MIN_MAX_PYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Multi-resolution min/max summary of the most recent samples, for drawing long windows.
+// Level 0 is a ring of the raw samples; level L holds the min and max of every aligned run of
+// 2^L samples, and each level is filled from the one below as its runs complete, so push() is
+// amortized O(1) (one parent update per sample on average). Any range of samples is covered
+// exactly by O(log n) aligned runs, so decimating a window into columns keeps every peak, however
+// short, in the column it belongs to. Starts out as if the whole ring had been filled with zeros.
+class MinMaxPyramid {
+private:
+    std::size_t length; // Ring length in samples, a power of two
+    std::size_t levels; // Level 0 plus one per halving down to a single run
+    std::vector<float> owned; // Storage, unless the caller supplied it
+    float* values; // Level 0
+    float* minima; // Levels 1 and up back to back, length >> L runs each
+    float* maxima;
+    std::uint64_t written; // Samples pushed, counting the initial ring of zeros
+
+    // Start of level L >= 1 in minima/maxima: the runs of levels 1 .. L - 1 come first
+    std::size_t offset(std::size_t level) const { return length - (length >> (level - 1)); }
+
+    // Min and max of the samples in [first, last), which must be in the ring
+    void range(std::uint64_t first, std::uint64_t last, float& low, float& high) const;
+
+public:
+    // Floats of storage a pyramid of this capacity needs
+    static std::size_t storage_floats(std::size_t capacity);
+
+    // - capacity: Most recent samples that can be queried (rounded up to a power of two)
+    // - storage: storage_floats(capacity) floats that outlive the pyramid (e.g. from an Arena),
+    //   or nullptr for the pyramid to allocate its own
+    explicit MinMaxPyramid(std::size_t capacity, float* storage = nullptr);
+
+    // Moves keep the storage; copies would share it
+    MinMaxPyramid(const MinMaxPyramid&) = delete;
+    MinMaxPyramid& operator=(const MinMaxPyramid&) = delete;
+    MinMaxPyramid(MinMaxPyramid&&) = default;
+    MinMaxPyramid& operator=(MinMaxPyramid&&) = default;
+
+    // Forget every sample, back to a ring of zeros
+    void reset();
+
+    void push(float value);
+
+    std::size_t capacity() const { return length; }
+
+    // Split the most recent count samples (count <= capacity()) into columns equal slices,
+    // oldest first, and write each slice's min and max as a pair: out needs 2 * columns floats.
+    // Columns narrower than a sample repeat the sample they fall on.
+    void decimate(std::size_t count, std::size_t columns, float* out) const;
+};
+
+#endif // MIN_MAX_PYRAMID_H
@@ -0,0 +1,110 @@
+#include "MirroredRing.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+std::size_t mirror_granularity() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? (std::size_t)page : 4096;
+#endif
+}
+
+#ifdef _WIN32
+
+const int MIRROR_MAP_ATTEMPTS = 8; // Retries if another thread takes the address range first
+
+void* map_mirrored(std::size_t bytes) {
+    const unsigned long long size = bytes;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)(size >> 32),
+                                        (DWORD)size, nullptr);
+    if (!mapping) {
+        return nullptr;
+    }
+    // Find 2 * bytes of free address space, release it, and map both views into it; another
+    // thread can grab the range in between, so try again if either view doesn't land
+    char* base = nullptr;
+    for (int attempt = 0; attempt < MIRROR_MAP_ATTEMPTS && !base; ++attempt) {
+        void* range = VirtualAlloc(nullptr, 2 * bytes, MEM_RESERVE, PAGE_NOACCESS);
+        if (!range) {
+            break;
+        }
+        VirtualFree(range, 0, MEM_RELEASE);
+        void* low = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, range);
+        void* high = low ? MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, (char*)range + bytes) : nullptr;
+        if (low && high) {
+            base = (char*)low;
+        } else if (low) {
+            UnmapViewOfFile(low);
+        }
+    }
+    // The views keep the mapping alive after its handle is closed
+    CloseHandle(mapping);
+    return base;
+}
+
+void unmap_mirrored(void* base, std::size_t bytes) {
+    UnmapViewOfFile((char*)base + bytes);
+    UnmapViewOfFile(base);
+}
+
+#else
+
+// An unlinked shared memory object of bytes bytes; -1 on failure
+static int open_anonymous(std::size_t bytes) {
+#if defined(__linux__)
+    int fd = memfd_create("emg-ring", MFD_CLOEXEC);
+#else
+    char name[64];
+    std::snprintf(name, sizeof(name), "/emg-ring-%ld-%p", (long)getpid(), (void*)&bytes);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        shm_unlink(name);
+    }
+#endif
+    if (fd >= 0 && ftruncate(fd, (off_t)bytes) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void* map_mirrored(std::size_t bytes) {
+    int fd = open_anonymous(bytes);
+    if (fd < 0) {
+        return nullptr;
+    }
+    // Reserve the whole range, then map the object over each half of it
+    char* base = (char*)mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base != MAP_FAILED) {
+        void* low = mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+        void* high = mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+        if (low == MAP_FAILED || high == MAP_FAILED) {
+            munmap(base, 2 * bytes);
+            base = nullptr;
+        }
+    } else {
+        base = nullptr;
+    }
+    // The mappings keep the object alive after its descriptor is closed
+    ::close(fd);
+    return base;
+}
+
+void unmap_mirrored(void* base, std::size_t bytes) {
+    munmap(base, 2 * bytes);
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef MIRRORED_RING_H
+#define MIRRORED_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Address space for a mirrored ring: 2 * bytes where the second half maps the same memory as
+// the first, so writes through either half show up in both. bytes must be a multiple of
+// mirror_granularity(). Returns nullptr where the platform can't do it.
+void* map_mirrored(std::size_t bytes);
+void unmap_mirrored(void* base, std::size_t bytes);
+
+// Size (bytes, a power of two) mirrored mappings are made in: the page size, or the allocation
+// granularity on Windows
+std::size_t mirror_granularity();
+
+// Ring of the most recent capacity() elements, indexed with a mask (capacity is a power of
+// two). Slot i is also readable at i + capacity, so any run of up to capacity consecutive
+// elements, including the latest window, is one contiguous span: FFT windows, block filters
+// and uploads read straight from it without splitting at the wrap.
+// The mirror is a second virtual mapping of the same pages where available (capacity then
+// rounds up to whole pages); otherwise both halves are stored and every write goes to both.
+// Starts out as if filled with zeros.
+// - T: Trivially copyable, with a power-of-two size so a whole number fits in a page
+template <typename T>
+class MirroredRing {
+    static_assert(std::is_trivially_copyable<T>::value, "MirroredRing elements must be trivially copyable");
+    static_assert((sizeof(T) & (sizeof(T) - 1)) == 0, "MirroredRing element size must be a power of two");
+
+private:
+    std::size_t length; // Capacity, a power of two
+    std::size_t mask;
+    T* slots; // 2 * length elements
+    bool mapped; // Second half aliases the first
+    std::vector<T> owned; // Both halves, when not mapped
+    std::uint64_t head; // Elements written
+
+    // Copy slots [first, first + n) (first < length) to their other half after a write
+    void mirror(std::size_t first, std::size_t n) {
+        std::size_t low = n < length - first ? n : length - first;
+        std::memcpy(slots + first + length, slots + first, low * sizeof(T));
+        std::memcpy(slots, slots + length, (n - low) * sizeof(T));
+    }
+
+    void release() {
+        if (mapped) {
+            unmap_mirrored(slots, length * sizeof(T));
+        }
+    }
+
+public:
+    // Holds at least capacity elements
+    explicit MirroredRing(std::size_t capacity) : length(1), slots(nullptr), mapped(false), head(0) {
+        while (length < capacity) {
+            length <<= 1;
+        }
+        std::size_t page_elements = mirror_granularity() / sizeof(T);
+        std::size_t paged = length > page_elements ? length : page_elements;
+        slots = (T*)map_mirrored(paged * sizeof(T));
+        if (slots) {
+            mapped = true;
+            length = paged;
+        } else {
+            owned.resize(2 * length);
+            slots = owned.data();
+        }
+        mask = length - 1;
+        reset();
+    }
+    ~MirroredRing() { release(); }
+
+    MirroredRing(const MirroredRing&) = delete;
+    MirroredRing& operator=(const MirroredRing&) = delete;
+    MirroredRing(MirroredRing&& other) noexcept
+        : length(other.length), mask(other.mask), slots(other.slots), mapped(other.mapped),
+          owned(std::move(other.owned)), head(other.head) {
+        other.slots = nullptr;
+        other.mapped = false;
+    }
+    MirroredRing& operator=(MirroredRing&& other) noexcept {
+        if (this != &other) {
+            release();
+            length = other.length;
+            mask = other.mask;
+            slots = other.slots;
+            mapped = other.mapped;
+            owned = std::move(other.owned);
+            head = other.head;
+            other.slots = nullptr;
+            other.mapped = false;
+        }
+        return *this;
+    }
+
+    // Back to all zeros
+    void reset() {
+        std::memset((void*)slots, 0, (mapped ? length : 2 * length) * sizeof(T));
+        head = 0;
+    }
+
+    std::size_t capacity() const { return length; }
+    bool is_mapped() const { return mapped; }
+    std::uint64_t written() const { return head; }
+
+    void push(const T& value) {
+        std::size_t slot = head & mask;
+        slots[slot] = value;
+        if (!mapped) {
+            slots[slot + length] = value;
+        }
+        ++head;
+    }
+
+    // Contiguous room for the next (up to capacity()) elements: fill it, then commit() them
+    T* prepare() { return slots + (head & mask); }
+    void commit(std::size_t n) {
+        if (!mapped) {
+            mirror(head & mask, n);
+        }
+        head += n;
+    }
+
+    // Append n elements; only the last capacity() are kept if there are more
+    void push(const T* values, std::size_t n) {
+        if (n > length) {
+            head += n - length;
+            values += n - length;
+            n = length;
+        }
+        std::memcpy(prepare(), values, n * sizeof(T));
+        commit(n);
+    }
+
+    // The most recent n elements (n <= capacity()), oldest first
+    const T* latest(std::size_t n) const { return slots + ((head - n) & mask); }
+};
+
+#endif // MIRRORED_RING_H
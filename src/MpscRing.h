@@ -0,0 +1,75 @@
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded multi-producer/single-consumer ring buffer
+// - T: Element type (copy-assignable)
+// - Capacity: Number of slots, must be a power of two
+// Any number of threads may call try_push; one thread may call try_pop.
+// Each slot carries a sequence number (Vyukov's bounded queue), so producers
+// claim slots with a single CAS and never wait on each other or on the consumer.
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    alignas(64) std::atomic<std::size_t> enqueue_position{0}; // Shared by producers
+    alignas(64) std::size_t dequeue_position = 0; // Owned by the consumer
+    alignas(64) Cell cells[Capacity];
+
+public:
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Push one element; returns false if the ring is full
+    bool try_push(const T& value) {
+        std::size_t position = enqueue_position.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[position & MASK];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+            if (diff == 0) {
+                // Slot is free for this lap; claim it
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Consumer hasn't freed this slot yet: full
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pop one element; returns false if the ring is empty (or the next slot is still being written)
+    bool try_pop(T& value) {
+        Cell* cell = &cells[dequeue_position & MASK];
+        if (cell->sequence.load(std::memory_order_acquire) != dequeue_position + 1) {
+            return false;
+        }
+        value = cell->value;
+        cell->sequence.store(dequeue_position + Capacity, std::memory_order_release);
+        ++dequeue_position;
+        return true;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+};
+
+#endif // MPSC_RING_H
@@ -0,0 +1,371 @@
+#include "NetworkSource.h"
+#include "Logger.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+typedef int socket_length_t;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int socket_t;
+typedef long socket_length_t;
+#endif
+
+const std::size_t TCP_BUFFER_SIZE = 4 * MAX_PACKET_SIZE; // Stream buffer; always room for one more whole packet
+const int UDP_RECEIVE_BUFFER = 4 << 20; // Kernel socket buffer requested for bursts (bytes)
+const int GAP_LOG_INTERVAL_MS = 1000; // Sequence gap warnings are rate limited to this interval
+
+static socket_t to_socket(std::intptr_t handle) { return (socket_t)handle; }
+
+// Winsock must be initialized once per process before any socket call
+static bool init_sockets() {
+#ifdef _WIN32
+    static bool initialized = false;
+    if (!initialized) {
+        WSADATA data;
+        initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+    return initialized;
+#else
+    return true;
+#endif
+}
+
+static bool set_nonblocking(socket_t s) {
+#ifdef _WIN32
+    u_long enabled = 1;
+    return ioctlsocket(s, FIONBIO, &enabled) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static void close_socket(socket_t s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+// True if the last socket call failed only because no data was ready
+static bool would_block() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// recv on a non-blocking socket: bytes received, 0 if nothing was ready, -1 on error or
+// (for TCP) when the peer closed the connection. truncated is set for oversized datagrams.
+static socket_length_t receive_some(socket_t s, unsigned char* buffer, std::size_t capacity, bool datagram, bool& truncated) {
+    truncated = false;
+#ifdef _WIN32
+    (void)datagram;
+    int n = recv(s, reinterpret_cast<char*>(buffer), (int)capacity, 0);
+    if (n == SOCKET_ERROR) {
+        if (WSAGetLastError() == WSAEMSGSIZE) {
+            truncated = true;
+            return (socket_length_t)capacity;
+        }
+        return would_block() ? 0 : -1;
+    }
+#else
+    // MSG_TRUNC reports a datagram's full length (on a stream it would discard data instead)
+    ssize_t n = recv(s, buffer, capacity, datagram ? MSG_TRUNC : 0);
+    if (n < 0) {
+        return would_block() ? 0 : -1;
+    }
+    if ((std::size_t)n > capacity) {
+        truncated = true;
+        n = (ssize_t)capacity;
+    }
+#endif
+    return n == 0 ? -1 : (socket_length_t)n;
+}
+
+NetworkSource::NetworkSource(std::size_t channels, float sample_rate)
+    : transport(Transport::Udp), handle(-1), count(channels), rate(sample_rate), pending(0), next(0),
+      stream_start(0), stream_end(0), borrowed_size(0), have_sequence(false), expected_sequence(0) {
+    std::memset(slot_length, 0, sizeof(slot_length));
+}
+
+NetworkSource::~NetworkSource() {
+    close();
+}
+
+bool NetworkSource::open_udp(std::uint16_t port) {
+    close();
+    if (!init_sockets()) {
+        LOG_ERROR("Failed to initialize sockets");
+        return false;
+    }
+
+    socket_t s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == (socket_t)-1) {
+        LOG_ERROR("Failed to create UDP socket");
+        return false;
+    }
+    int buffer_size = UDP_RECEIVE_BUFFER;
+    setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&buffer_size), sizeof(buffer_size));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || !set_nonblocking(s)) {
+        LOG_ERROR("Failed to listen on UDP port %u", (unsigned)port);
+        close_socket(s);
+        return false;
+    }
+
+    transport = Transport::Udp;
+    handle = (std::intptr_t)s;
+    storage.assign(RECEIVE_BATCH * MAX_PACKET_SIZE / sizeof(float), 0.0f);
+    LOG_INFO("Listening for %zu-channel sample packets on UDP port %u", count, (unsigned)port);
+    return true;
+}
+
+bool NetworkSource::open_tcp(const char* host, std::uint16_t port) {
+    close();
+    if (!init_sockets()) {
+        LOG_ERROR("Failed to initialize sockets");
+        return false;
+    }
+
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char service[8];
+    std::snprintf(service, sizeof(service), "%u", (unsigned)port);
+    addrinfo* results = nullptr;
+    if (getaddrinfo(host, service, &hints, &results) != 0) {
+        LOG_ERROR("Failed to resolve %s", host);
+        return false;
+    }
+
+    // Connect blocking, then switch to non-blocking reads
+    socket_t s = (socket_t)-1;
+    for (addrinfo* candidate = results; candidate; candidate = candidate->ai_next) {
+        s = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+        if (s == (socket_t)-1) {
+            continue;
+        }
+        if (connect(s, candidate->ai_addr, (int)candidate->ai_addrlen) == 0) {
+            break;
+        }
+        close_socket(s);
+        s = (socket_t)-1;
+    }
+    freeaddrinfo(results);
+    if (s == (socket_t)-1 || !set_nonblocking(s)) {
+        LOG_ERROR("Failed to connect to %s:%u", host, (unsigned)port);
+        if (s != (socket_t)-1) {
+            close_socket(s);
+        }
+        return false;
+    }
+
+    transport = Transport::Tcp;
+    handle = (std::intptr_t)s;
+    storage.assign(TCP_BUFFER_SIZE / sizeof(float), 0.0f);
+    LOG_INFO("Receiving %zu-channel sample packets from %s:%u over TCP", count, host, (unsigned)port);
+    return true;
+}
+
+void NetworkSource::close() {
+    if (handle != -1) {
+        close_socket(to_socket(handle));
+    }
+    if (stats.packets > 0 || stats.malformed_packets > 0) {
+        LOG_INFO("Network source closed: %llu packets, %llu lost, %llu late, %llu malformed",
+                 (unsigned long long)stats.packets, (unsigned long long)stats.lost_packets,
+                 (unsigned long long)stats.late_packets, (unsigned long long)stats.malformed_packets);
+    }
+    handle = -1;
+    pending = next = 0;
+    stream_start = stream_end = borrowed_size = 0;
+    have_sequence = false;
+    stats = NetworkStats();
+}
+
+// Validate one received packet and track its sequence number;
+// returns its samples, or nullptr if the packet should be skipped
+const float* NetworkSource::accept_packet(const unsigned char* packet, std::size_t length, std::size_t& frames) {
+    PacketHeader header;
+    if (length < sizeof(header)) {
+        ++stats.malformed_packets;
+        return nullptr;
+    }
+    std::memcpy(&header, packet, sizeof(header));
+    std::size_t payload = (std::size_t)header.frames * header.channels * sizeof(float);
+    if (header.magic != PACKET_MAGIC || header.channels != count || header.frames == 0 || length != sizeof(header) + payload) {
+        ++stats.malformed_packets;
+        LOG_EVERY(GAP_LOG_INTERVAL_MS, LogLevel::Warning, "Discarding malformed sample packet (%zu bytes)", length);
+        return nullptr;
+    }
+
+    if (have_sequence) {
+        // Unsigned distance ahead of the expected sequence; anything "behind" wraps to a huge value
+        std::uint32_t gap = header.sequence - expected_sequence;
+        if (gap >= 0x80000000u) {
+            ++stats.late_packets;
+            return nullptr;
+        }
+        if (gap > 0) {
+            stats.lost_packets += gap;
+            LOG_EVERY(GAP_LOG_INTERVAL_MS, LogLevel::Warning, "Sequence gap: %u packets lost before packet %u (%llu lost in total)",
+                      gap, header.sequence, (unsigned long long)stats.lost_packets);
+        }
+    }
+    have_sequence = true;
+    expected_sequence = header.sequence + 1;
+
+    ++stats.packets;
+    stats.frames += header.frames;
+    frames = header.frames;
+    return reinterpret_cast<const float*>(packet + sizeof(header));
+}
+
+// Fill the UDP slots with whatever datagrams are queued; returns the number received
+std::size_t NetworkSource::receive_datagrams() {
+    socket_t s = to_socket(handle);
+    unsigned char* base = bytes();
+#if defined(__linux__)
+    mmsghdr messages[RECEIVE_BATCH];
+    iovec vectors[RECEIVE_BATCH];
+    std::memset(messages, 0, sizeof(messages));
+    for (std::size_t i = 0; i < RECEIVE_BATCH; ++i) {
+        vectors[i].iov_base = base + i * MAX_PACKET_SIZE;
+        vectors[i].iov_len = MAX_PACKET_SIZE;
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int received = recvmmsg(s, messages, RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+        return 0;
+    }
+    for (int i = 0; i < received; ++i) {
+        // A truncated datagram can't match its header's length, so accept_packet rejects it
+        slot_length[i] = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) ? 0 : messages[i].msg_len;
+    }
+    return (std::size_t)received;
+#else
+    std::size_t received = 0;
+    while (received < RECEIVE_BATCH) {
+        bool truncated;
+        socket_length_t n = receive_some(s, base + received * MAX_PACKET_SIZE, MAX_PACKET_SIZE, true, truncated);
+        if (n <= 0) {
+            break;
+        }
+        slot_length[received++] = truncated ? 0 : (std::size_t)n;
+    }
+    return received;
+#endif
+}
+
+const float* NetworkSource::acquire_udp(std::size_t& frames) {
+    for (;;) {
+        if (next == pending) {
+            next = 0;
+            pending = receive_datagrams();
+            if (pending == 0) {
+                return nullptr;
+            }
+        }
+        const float* samples = accept_packet(bytes() + next * MAX_PACKET_SIZE, slot_length[next], frames);
+        if (samples) {
+            return samples;
+        }
+        ++next;
+    }
+}
+
+const float* NetworkSource::acquire_tcp(std::size_t& frames) {
+    unsigned char* base = bytes();
+    for (;;) {
+        std::size_t available = stream_end - stream_start;
+        if (available >= sizeof(PacketHeader)) {
+            PacketHeader header;
+            std::memcpy(&header, base + stream_start, sizeof(header));
+            std::size_t size = sizeof(header) + (std::size_t)header.frames * header.channels * sizeof(float);
+            if (header.magic != PACKET_MAGIC || size > MAX_PACKET_SIZE) {
+                // No way to find the next packet boundary on a corrupt stream
+                LOG_ERROR("Corrupt sample stream, disconnecting");
+                ++stats.malformed_packets;
+                close_socket(to_socket(handle));
+                handle = -1;
+                return nullptr;
+            }
+            if (available >= size) {
+                const float* samples = accept_packet(base + stream_start, size, frames);
+                if (samples) {
+                    borrowed_size = size;
+                    return samples;
+                }
+                stream_start += size;
+                continue;
+            }
+        }
+
+        // Keep a whole packet's worth of space after the unconsumed bytes
+        if (stream_start > 0 && TCP_BUFFER_SIZE - stream_end < MAX_PACKET_SIZE) {
+            std::memmove(base, base + stream_start, stream_end - stream_start);
+            stream_end -= stream_start;
+            stream_start = 0;
+        }
+
+        bool truncated;
+        socket_length_t n = receive_some(to_socket(handle), base + stream_end, TCP_BUFFER_SIZE - stream_end, false, truncated);
+        if (n == 0) {
+            return nullptr;
+        }
+        if (n < 0) {
+            LOG_WARNING("Sample stream connection closed");
+            close_socket(to_socket(handle));
+            handle = -1;
+            return nullptr;
+        }
+        stream_end += (std::size_t)n;
+    }
+}
+
+const float* NetworkSource::acquire(std::size_t& frames) {
+    frames = 0;
+    if (handle == -1) {
+        return nullptr;
+    }
+    return transport == Transport::Udp ? acquire_udp(frames) : acquire_tcp(frames);
+}
+
+void NetworkSource::release() {
+    if (transport == Transport::Udp) {
+        ++next;
+    } else {
+        stream_start += borrowed_size;
+        borrowed_size = 0;
+    }
+}
+
+void NetworkSource::resync() {
+    // Consume everything that has arrived; sequence tracking sees it, so no false gaps on resume
+    std::size_t frames;
+    while (acquire(frames)) {
+        release();
+    }
+}
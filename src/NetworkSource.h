@@ -0,0 +1,95 @@
+#ifndef NETWORK_SOURCE_H
+#define NETWORK_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SampleSource.h"
+
+// Wire format: each packet is a PacketHeader followed by frames * channels float32 samples,
+// interleaved [frame][channel], little-endian. Over UDP one datagram carries one packet;
+// over TCP packets follow each other on the stream.
+const std::uint32_t PACKET_MAGIC = 0x50474D45; // "EMGP" read as a little-endian word
+const std::size_t MAX_PACKET_SIZE = 65536; // Largest accepted packet, header included
+const std::size_t RECEIVE_BATCH = 32; // UDP datagrams received per system call
+
+struct PacketHeader {
+    std::uint32_t magic;
+    std::uint32_t sequence; // Increments by one per packet; gaps mean lost packets
+    std::uint16_t channels;
+    std::uint16_t frames;
+    std::uint32_t reserved; // Zero; pads the header so samples start 16-byte aligned
+};
+
+static_assert(sizeof(PacketHeader) == 16, "PacketHeader must stay 16 bytes");
+
+enum class Transport {
+    Udp,
+    Tcp
+};
+
+struct NetworkStats {
+    std::uint64_t packets = 0; // Packets accepted
+    std::uint64_t frames = 0; // Frames in accepted packets
+    std::uint64_t lost_packets = 0; // Packets missing from the sequence
+    std::uint64_t late_packets = 0; // Duplicate or reordered packets (discarded)
+    std::uint64_t malformed_packets = 0; // Bad magic, wrong channel count, truncated
+};
+
+// Receives live sample packets from acquisition hardware. Packets land directly in
+// preallocated slots (one receive slot per datagram for UDP, a linear stream buffer for TCP)
+// and acquire() returns a pointer to the samples inside the slot, so nothing is copied
+// between the socket and the filter chain. Reads never block; with nothing pending,
+// acquire() returns nullptr. On Linux, UDP slots are filled RECEIVE_BATCH at a time with recvmmsg.
+class NetworkSource : public SampleSource {
+private:
+    Transport transport;
+    std::intptr_t handle; // Socket, -1 when closed
+    std::size_t count; // Channels expected in every packet
+    float rate;
+
+    // UDP: RECEIVE_BATCH slots of MAX_PACKET_SIZE bytes; TCP: one buffer of several packets.
+    // Stored as floats so every packet payload is float aligned.
+    std::vector<float> storage;
+    std::size_t slot_length[RECEIVE_BATCH]; // Bytes received into each UDP slot
+    std::size_t pending; // UDP slots received but not yet handed out
+    std::size_t next; // Next UDP slot to hand out
+    std::size_t stream_start; // TCP: first unconsumed byte
+    std::size_t stream_end; // TCP: end of received bytes
+    std::size_t borrowed_size; // TCP: size of the packet lent out by acquire()
+
+    bool have_sequence;
+    std::uint32_t expected_sequence;
+    NetworkStats stats;
+
+    unsigned char* bytes() { return reinterpret_cast<unsigned char*>(storage.data()); }
+    const float* accept_packet(const unsigned char* packet, std::size_t length, std::size_t& frames);
+    std::size_t receive_datagrams();
+    const float* acquire_udp(std::size_t& frames);
+    const float* acquire_tcp(std::size_t& frames);
+
+public:
+    NetworkSource(std::size_t channels, float sample_rate);
+    ~NetworkSource();
+
+    NetworkSource(const NetworkSource&) = delete;
+    NetworkSource& operator=(const NetworkSource&) = delete;
+
+    // Listen for datagrams on port (all interfaces)
+    bool open_udp(std::uint16_t port);
+
+    // Connect to an acquisition server streaming packets over TCP
+    bool open_tcp(const char* host, std::uint16_t port);
+
+    void close();
+
+    std::size_t channels() const override { return count; }
+    float sample_rate() const override { return rate; }
+    const float* acquire(std::size_t& frames) override;
+    void release() override;
+    void resync() override;
+
+    const NetworkStats& statistics() const { return stats; }
+};
+
+#endif // NETWORK_SOURCE_H
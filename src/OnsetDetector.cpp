@@ -0,0 +1,79 @@
+#include "OnsetDetector.h"
+#include "Latency.h"
+#include <cmath>
+
+#define PI 3.14159265358979323846
+
+OnsetDetector::OnsetDetector()
+    : count(0), settings(), smoothing(0.0f), states(nullptr), frame_count(0), event_callback(nullptr),
+      event_context(nullptr) {}
+
+OnsetDetector::OnsetDetector(std::size_t channels, float sample_rate, const OnsetSettings& settings,
+                             ChannelState* storage)
+    : count(channels), settings(settings),
+      smoothing((float)(1.0 - std::exp(-2.0 * PI * TKEO_SMOOTHING_HZ / sample_rate))), states(storage),
+      frame_count(0), event_callback(nullptr), event_context(nullptr) {
+    if (this->settings.hold_frames == 0) {
+        this->settings.hold_frames = 1;
+    }
+    reset();
+}
+
+void OnsetDetector::reset() {
+    for (std::size_t c = 0; c < count; ++c) {
+        states[c] = ChannelState();
+    }
+    frame_count = 0;
+}
+
+std::size_t OnsetDetector::process(const float* in, std::size_t frames, std::size_t stride) {
+    const float on = settings.onset_threshold, off = settings.offset_threshold;
+    const std::uint32_t hold = (std::uint32_t)settings.hold_frames;
+    std::size_t fired = 0;
+
+    // Frame by frame across channels, so events come out in frame order
+    for (std::size_t f = 0; f < frames; ++f) {
+        const float* frame = in + f * stride;
+        for (std::size_t c = 0; c < count; ++c) {
+            ChannelState& state = states[c];
+            float level = frame[c];
+            if (settings.tkeo) {
+                // psi for the previous frame, now its successor is known
+                float x = frame[c];
+                float psi = state.current * state.current - state.previous * x;
+                state.previous = state.current;
+                state.current = x;
+                state.smoothed += smoothing * (std::fabs(psi) - state.smoothed);
+                level = state.smoothed;
+            }
+
+            // A run counts frames past the threshold that would change the state
+            bool past = state.active ? level < off : level > on;
+            if (!past) {
+                state.run = 0;
+                continue;
+            }
+            if (state.run++ == 0) {
+                state.run_start = frame_count + f;
+            }
+            if (state.run < hold) {
+                continue;
+            }
+            state.active = !state.active;
+            state.run = 0;
+            ++fired;
+            if (event_callback) {
+                MuscleEvent event;
+                event.frame = state.run_start;
+                event.detected = frame_count + f;
+                event.time = latency_now();
+                event.channel = (std::uint32_t)c;
+                event.type = state.active ? MuscleEventType::Onset : MuscleEventType::Offset;
+                event.level = level;
+                event_callback(event_context, event);
+            }
+        }
+    }
+    frame_count += frames;
+    return fired;
+}
@@ -0,0 +1,68 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Philox4x32-10 counter-based random number generator (Salmon et al., "Parallel random numbers:
+// as easy as 1, 2, 3"). Each call maps a 128-bit counter and a 64-bit key to four independent
+// 32-bit words with no state carried between calls, so any draw can be computed directly from
+// what it is for (e.g. key = seed, counter = frame, channel and purpose). Streams never need
+// to be advanced in order, split or shared between threads.
+struct PhiloxKey {
+    std::uint32_t k0, k1;
+};
+
+struct PhiloxCounter {
+    std::uint32_t c0, c1, c2, c3;
+};
+
+const std::uint32_t PHILOX_M0 = 0xD2511F53u;
+const std::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const std::uint32_t PHILOX_W0 = 0x9E3779B9u; // Key schedule increments (golden ratio, sqrt(3) - 1)
+const std::uint32_t PHILOX_W1 = 0xBB67AE85u;
+const int PHILOX_ROUNDS = 10;
+
+inline PhiloxKey philox_key(std::uint64_t seed) {
+    return { (std::uint32_t)seed, (std::uint32_t)(seed >> 32) };
+}
+
+inline PhiloxCounter philox4x32(PhiloxCounter x, PhiloxKey key) {
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        std::uint64_t p0 = (std::uint64_t)PHILOX_M0 * x.c0;
+        std::uint64_t p1 = (std::uint64_t)PHILOX_M1 * x.c2;
+        x = { (std::uint32_t)(p1 >> 32) ^ x.c1 ^ key.k0, (std::uint32_t)p1, (std::uint32_t)(p0 >> 32) ^ x.c3 ^ key.k1,
+              (std::uint32_t)p0 };
+        key.k0 += PHILOX_W0;
+        key.k1 += PHILOX_W1;
+    }
+    return x;
+}
+
+// philox4x32 over LANES counters at once, held as one array per counter word and updated in
+// place. Counters differ only in c2 here (e.g. one per channel), which is all the generator
+// needs; running the rounds outside the lane loop lets it vectorize.
+template <std::size_t LANES>
+inline void philox4x32_lanes(std::uint32_t (&c0)[LANES], std::uint32_t (&c1)[LANES], std::uint32_t (&c2)[LANES],
+                             std::uint32_t (&c3)[LANES], PhiloxKey key) {
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        for (std::size_t l = 0; l < LANES; ++l) {
+            std::uint64_t p0 = (std::uint64_t)PHILOX_M0 * c0[l];
+            std::uint64_t p1 = (std::uint64_t)PHILOX_M1 * c2[l];
+            std::uint32_t x1 = c1[l], x3 = c3[l];
+            c0[l] = (std::uint32_t)(p1 >> 32) ^ x1 ^ key.k0;
+            c1[l] = (std::uint32_t)p1;
+            c2[l] = (std::uint32_t)(p0 >> 32) ^ x3 ^ key.k1;
+            c3[l] = (std::uint32_t)p0;
+        }
+        key.k0 += PHILOX_W0;
+        key.k1 += PHILOX_W1;
+    }
+}
+
+// The top 24 bits of a word as a uniform float in [0, 1) (every representable step)
+inline float philox_uniform(std::uint32_t word) {
+    return (word >> 8) * (1.0f / 16777216.0f);
+}
+
+#endif // PHILOX_H
@@ -0,0 +1,95 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Chain of processing stages fused into one loop
+// - Stages: Any types with a `float process(float)` member (Filter, PreciseFilter, SosCascade,
+//   Rectifier, MovingEnvelope, EnvelopeDetector, ...), run in order
+// Each sample goes through every stage before the next one is read, so a block is read and
+// written once instead of once per stage, and with every stage's process(float) inlined there
+// is no dispatch between them. For the block calls, trivially copyable stages (filters, the
+// rectifier, cascades) are copied into locals, so the compiler can see that stores to the output
+// can't touch their state and keeps it in registers; stages that own memory (moving windows)
+// run in place. Taps expose the intermediate signals: tap 0 is the input and tap k + 1 is the
+// output of stage k.
+template <typename... Stages>
+class Pipeline {
+    static_assert(sizeof...(Stages) >= 1, "Pipeline needs at least one stage");
+
+public:
+    static constexpr std::size_t STAGES = sizeof...(Stages);
+    static constexpr std::size_t TAPS = STAGES + 1; // Input plus every stage output
+
+private:
+    std::tuple<Stages...> chain;
+
+    // A stage as held for the length of one block: a copy if that's safe, else a reference
+    template <typename Stage>
+    using Local = typename std::conditional<std::is_trivially_copyable<Stage>::value, Stage, Stage&>::type;
+    typedef std::tuple<Local<Stages>...> LocalChain;
+
+    template <std::size_t... I>
+    LocalChain load(std::index_sequence<I...>) { return LocalChain(std::get<I>(chain)...); }
+
+    // Write the block's copies back; stages run in place are already up to date
+    template <std::size_t I>
+    void store_stage(LocalChain& local) {
+        if constexpr (!std::is_reference<typename std::tuple_element<I, LocalChain>::type>::value) {
+            std::get<I>(chain) = std::get<I>(local);
+        }
+    }
+
+    template <std::size_t... I>
+    void store(LocalChain& local, std::index_sequence<I...>) {
+        (store_stage<I>(local), ...);
+    }
+
+    template <typename Chain, std::size_t... I>
+    static float run(Chain& stages, float value, std::index_sequence<I...>) {
+        ((value = std::get<I>(stages).process(value)), ...);
+        return value;
+    }
+
+    template <typename Chain, std::size_t... I>
+    static void run_taps(Chain& stages, float value, float* taps, std::index_sequence<I...>) {
+        taps[0] = value;
+        ((taps[I + 1] = value = std::get<I>(stages).process(value)), ...);
+    }
+
+public:
+    explicit Pipeline(Stages... stages) : chain(std::move(stages)...) {}
+
+    // Access a stage, e.g. to retune a filter
+    template <std::size_t I>
+    typename std::tuple_element<I, std::tuple<Stages...>>::type& stage() { return std::get<I>(chain); }
+
+    // Process a single input sample through every stage and return the last stage's output
+    float process(float input) { return run(chain, input, std::index_sequence_for<Stages...>()); }
+
+    // Process a block of n samples from in to out (in and out may be the same buffer)
+    void process(const float* in, float* out, std::size_t n) {
+        const auto indices = std::index_sequence_for<Stages...>();
+        LocalChain local = load(indices);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = run(local, in[i], indices);
+        }
+        store(local, indices);
+    }
+
+    // Process a block of n samples, writing every tap of each sample as one frame of TAPS
+    // floats (taps + i * TAPS), so a struct of TAPS floats can receive a sample directly
+    void process_taps(const float* in, float* taps, std::size_t n) {
+        const auto indices = std::index_sequence_for<Stages...>();
+        LocalChain local = load(indices);
+        for (std::size_t i = 0; i < n; ++i) {
+            run_taps(local, in[i], taps + i * TAPS, indices);
+        }
+        store(local, indices);
+    }
+};
+
+#endif // PIPELINE_H
@@ -0,0 +1,179 @@
+#include "PolyphaseDecimator.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define PI 3.14159265358979323846
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+        double half = x / (2.0 * k);
+        term *= half * half;
+        sum += term;
+    }
+    return sum;
+}
+
+static std::size_t gcd(std::size_t a, std::size_t b) {
+    while (b != 0) {
+        std::size_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+bool PolyphaseDecimator::ratio(float input_rate, float output_rate, std::size_t& up, std::size_t& down) {
+    up = down = 0;
+    if (!(output_rate > 0.0f) || !(output_rate < input_rate) || std::floor(input_rate) != input_rate ||
+        std::floor(output_rate) != output_rate) {
+        return false;
+    }
+    std::size_t in = (std::size_t)input_rate, out = (std::size_t)output_rate;
+    std::size_t divisor = gcd(in, out);
+    if (out / divisor > MAX_PHASES) {
+        return false;
+    }
+    up = out / divisor;
+    down = in / divisor;
+    return true;
+}
+
+std::size_t PolyphaseDecimator::branch_length(std::size_t up, std::size_t down) {
+    // The transition runs from a quarter to three quarters of the output rate, 0.5 / down of
+    // the up-sampled rate wide (Kaiser's length estimate for the attenuation)
+    double transition = 0.5 / down;
+    std::size_t length = (std::size_t)std::ceil((ATTENUATION_DB - 7.95) / (14.36 * transition)) + 1;
+    return (length + up - 1) / up;
+}
+
+std::size_t PolyphaseDecimator::history_frames(std::size_t branch_taps, std::size_t block_frames) {
+    // Room for several blocks past the taps, so the history is shifted back only now and then
+    return 4 * (branch_taps - 1) + block_frames;
+}
+
+std::size_t PolyphaseDecimator::storage_floats(std::size_t channels, float input_rate, float output_rate,
+                                               std::size_t block_frames) {
+    std::size_t up, down;
+    if (!ratio(input_rate, output_rate, up, down)) {
+        return 0;
+    }
+    std::size_t taps = branch_length(up, down);
+    return up * taps + history_frames(taps, block_frames) * simd::round_up(channels);
+}
+
+std::size_t PolyphaseDecimator::max_output(float input_rate, float output_rate, std::size_t block_frames) {
+    std::size_t up, down;
+    if (!ratio(input_rate, output_rate, up, down)) {
+        return 0;
+    }
+    return (block_frames * up + down - 1) / down + 1;
+}
+
+PolyphaseDecimator::PolyphaseDecimator()
+    : count(0), padded(0), up(0), down(0), branch_taps(0), capacity(0), end(0), next(0), phase(0),
+      coefficients(nullptr), history(nullptr) {}
+
+PolyphaseDecimator::PolyphaseDecimator(std::size_t channels, float input_rate, float output_rate,
+                                       std::size_t block_frames, float* storage)
+    : count(channels), padded(simd::round_up(channels)), up(0), down(0), branch_taps(0), capacity(0), end(0),
+      next(0), phase(0), coefficients(nullptr), history(nullptr) {
+    if (!ratio(input_rate, output_rate, up, down)) {
+        count = 0;
+        return;
+    }
+    branch_taps = branch_length(up, down);
+    capacity = history_frames(branch_taps, block_frames);
+    if (!storage) {
+        owned.resize(storage_floats(channels, input_rate, output_rate, block_frames));
+        storage = owned.data();
+    }
+    coefficients = storage;
+    history = storage + up * branch_taps;
+
+    // Windowed sinc at up * input_rate, cut off halfway through the transition, split into
+    // branches with tap 0 nearest the output. Scaled to a gain of up so each branch passes DC
+    // at unity, since only one input in every up lands on a branch tap.
+    const std::size_t length = up * branch_taps;
+    const double cutoff = 0.5 / down; // Cycles per up-sampled frame
+    const double beta = 0.1102 * (ATTENUATION_DB - 8.7);
+    const double centre = 0.5 * (length - 1);
+    std::vector<double> prototype(length);
+    double sum = 0.0;
+    for (std::size_t n = 0; n < length; ++n) {
+        double t = n - centre;
+        double sinc = t == 0.0 ? 1.0 : std::sin(2.0 * PI * cutoff * t) / (2.0 * PI * cutoff * t);
+        double x = length > 1 ? 2.0 * n / (length - 1) - 1.0 : 0.0;
+        prototype[n] = 2.0 * cutoff * sinc * bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - x * x)));
+        sum += prototype[n];
+    }
+    for (std::size_t p = 0; p < up; ++p) {
+        for (std::size_t k = 0; k < branch_taps; ++k) {
+            coefficients[p * branch_taps + k] = (float)(prototype[p + k * up] * up / sum);
+        }
+    }
+    reset();
+}
+
+void PolyphaseDecimator::reset() {
+    if (!history) {
+        return;
+    }
+    std::fill(history, history + capacity * padded, 0.0f);
+    // The first output lines up with the first input frame, behind a full set of zero taps
+    end = branch_taps - 1;
+    next = branch_taps - 1;
+    phase = 0;
+}
+
+float PolyphaseDecimator::delay() const {
+    return up > 0 ? (float)(0.5 * (up * branch_taps - 1) / up) : 0.0f;
+}
+
+std::size_t PolyphaseDecimator::process(const float* in, std::size_t frames, std::size_t stride, float* out) {
+    using namespace simd;
+
+    if (count == 0) {
+        return 0;
+    }
+    // Shift the frames still needed back to the start once the new ones wouldn't fit
+    if (end + frames > capacity) {
+        std::size_t keep = std::min(next, end) - (branch_taps - 1);
+        std::memmove(history, history + keep * padded, (end - keep) * padded * sizeof(float));
+        end -= keep;
+        next -= keep;
+    }
+    for (std::size_t f = 0; f < frames; ++f) {
+        std::memcpy(history + (end + f) * padded, in + f * stride, count * sizeof(float));
+    }
+    end += frames;
+
+    const std::size_t vector_channels = count - count % WIDTH;
+    std::size_t written = 0;
+    while (next < end) {
+        const float* branch = coefficients + phase * branch_taps;
+        const float* newest = history + next * padded;
+        float* dst = out + written * count;
+        for (std::size_t c = 0; c < padded; c += WIDTH) {
+            vfloat acc = mul(set1(branch[0]), load(newest + c));
+            for (std::size_t k = 1; k < branch_taps; ++k) {
+                acc = add(acc, mul(set1(branch[k]), load(newest - k * padded + c)));
+            }
+            if (c < vector_channels) {
+                store(dst + c, acc);
+            } else {
+                float lanes[WIDTH];
+                store(lanes, acc);
+                std::copy(lanes, lanes + (count - c), dst + c);
+            }
+        }
+        ++written;
+        phase += down;
+        next += phase / up;
+        phase %= up;
+    }
+    return written;
+}
@@ -0,0 +1,81 @@
+#ifndef POLYPHASE_DECIMATOR_H
+#define POLYPHASE_DECIMATOR_H
+
+#include <cstddef>
+#include <vector>
+
+// Rational-rate downsampler for a bank of channels, e.g. a 2 kHz envelope to 50 or 60 Hz.
+// The rates are reduced to up / down (60 / 2000 = 3 / 100) and a Kaiser-windowed sinc low-pass
+// is designed at up * input_rate, then split into up polyphase branches. Only the output
+// samples that are kept are computed, each one branch's dot product over its taps, so the cost
+// is per output sample rather than per input sample. The passband is flat to a quarter of the
+// output rate and everything that would alias into it is down by ATTENUATION_DB; the filter
+// delays the signal by delay() input frames.
+// Samples are interleaved as [frame][channel] and each tap runs across channels with SIMD.
+class PolyphaseDecimator {
+public:
+    static constexpr std::size_t MAX_PHASES = 256; // Largest up factor once the ratio is reduced
+    static constexpr float ATTENUATION_DB = 60.0f;
+
+    // Reduce output_rate / input_rate to up / down; false (up = down = 0) unless both rates are
+    // whole numbers of Hz, the output is slower, and up is at most MAX_PHASES
+    static bool ratio(float input_rate, float output_rate, std::size_t& up, std::size_t& down);
+
+    // Floats of storage a decimator of this shape needs; the rates must pass ratio()
+    static std::size_t storage_floats(std::size_t channels, float input_rate, float output_rate,
+                                      std::size_t block_frames);
+
+    // Most output frames one process() call of block_frames frames can produce
+    static std::size_t max_output(float input_rate, float output_rate, std::size_t block_frames);
+
+    PolyphaseDecimator();
+
+    // - block_frames: Most frames one process() call takes
+    // - storage: storage_floats() floats that outlive the decimator (e.g. from an Arena), or
+    //   nullptr for the decimator to allocate its own
+    PolyphaseDecimator(std::size_t channels, float input_rate, float output_rate, std::size_t block_frames,
+                       float* storage = nullptr);
+
+    // Moves keep the storage; copies would share it
+    PolyphaseDecimator(const PolyphaseDecimator&) = delete;
+    PolyphaseDecimator& operator=(const PolyphaseDecimator&) = delete;
+    PolyphaseDecimator(PolyphaseDecimator&&) = default;
+    PolyphaseDecimator& operator=(PolyphaseDecimator&&) = default;
+
+    // Clear the history, as if the input had been zero
+    void reset();
+
+    std::size_t channels() const { return count; }
+    std::size_t taps() const { return branch_taps; } // Per polyphase branch
+    float delay() const; // Group delay in input frames
+    std::size_t up_factor() const { return up; }
+    std::size_t down_factor() const { return down; }
+
+    // Taps of one polyphase branch, tap 0 multiplying the newest input
+    const float* branch(std::size_t phase) const { return coefficients + phase * branch_taps; }
+
+    // Take up to block_frames frames of channels samples each from in (of stride samples per
+    // frame) and write the output frames now due to out, channels samples each; returns how
+    // many were written
+    std::size_t process(const float* in, std::size_t frames, std::size_t stride, float* out);
+    std::size_t process(const float* in, std::size_t frames, float* out) { return process(in, frames, count, out); }
+
+private:
+    std::size_t count;
+    std::size_t padded; // Channels rounded up to the vector width
+    std::size_t up, down;
+    std::size_t branch_taps;
+    std::size_t capacity; // History frames
+    std::size_t end; // History frame after the newest
+    std::size_t next; // Input frames past the history start of the next output
+    std::size_t phase; // Branch of the next output
+    std::vector<float> owned; // Storage, unless the caller supplied it
+    float* coefficients; // [branch][tap], tap 0 multiplying the newest input
+    float* history; // [frame][padded], oldest first
+
+    // History frames kept between blocks so every branch sees its taps
+    static std::size_t history_frames(std::size_t branch_taps, std::size_t block_frames);
+    static std::size_t branch_length(std::size_t up, std::size_t down);
+};
+
+#endif // POLYPHASE_DECIMATOR_H
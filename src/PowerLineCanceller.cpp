@@ -0,0 +1,187 @@
+#include "PowerLineCanceller.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cmath>
+
+#define PI 3.14159265358979323846
+
+std::size_t PowerLineCanceller::storage_floats(std::size_t channels, std::size_t harmonics) {
+    return 2 * harmonics * (simd::round_up(channels) + CHUNK_FRAMES * simd::WIDTH);
+}
+
+PowerLineCanceller::PowerLineCanceller()
+    : count(0), padded(0), harmonic_count(0), normalized_step(0.0f), weights(nullptr), reference(nullptr),
+      phase_re(), phase_im(), rotate_re(), rotate_im() {}
+
+PowerLineCanceller::PowerLineCanceller(std::size_t channels, float sample_rate, float frequency,
+                                       std::size_t harmonics, float step, float* storage)
+    : count(channels), padded(simd::round_up(channels)),
+      harmonic_count(std::min(std::max<std::size_t>(harmonics, 1), MAX_HARMONICS)),
+      normalized_step(step / harmonic_count), weights(storage),
+      reference(storage + 2 * harmonic_count * simd::round_up(channels)),
+      phase_re(), phase_im(), rotate_re(), rotate_im() {
+    for (std::size_t h = 0; h < harmonic_count; ++h) {
+        double omega = 2.0 * PI * frequency * (h + 1) / sample_rate;
+        rotate_re[h] = std::cos(omega);
+        rotate_im[h] = std::sin(omega);
+    }
+    reset();
+}
+
+void PowerLineCanceller::reset() {
+    std::fill(weights, weights + 2 * harmonic_count * padded, 0.0f);
+    for (std::size_t h = 0; h < harmonic_count; ++h) {
+        phase_re[h] = 1.0;
+        phase_im[h] = 0.0;
+    }
+}
+
+void PowerLineCanceller::generate_reference(std::size_t frames) {
+    using namespace simd;
+
+    const std::size_t taps = 2 * harmonic_count;
+    for (std::size_t h = 0; h < harmonic_count; ++h) {
+        double re = phase_re[h], im = phase_im[h];
+        const double c = rotate_re[h], s = rotate_im[h];
+        for (std::size_t f = 0; f < frames; ++f) {
+            store(reference + (f * taps + 2 * h) * WIDTH, set1((float)re));
+            store(reference + (f * taps + 2 * h + 1) * WIDTH, set1((float)im));
+            double next = re * c - im * s;
+            im = re * s + im * c;
+            re = next;
+        }
+        // Pull the phasor back onto the unit circle so rounding can't grow or shrink it
+        double correction = 1.5 - 0.5 * (re * re + im * im);
+        phase_re[h] = re * correction;
+        phase_im[h] = im * correction;
+    }
+}
+
+float PowerLineCanceller::amplitude(std::size_t channel, std::size_t harmonic) const {
+    float in_phase = weights[2 * harmonic * padded + channel];
+    float quadrature = weights[(2 * harmonic + 1) * padded + channel];
+    return std::sqrt(in_phase * in_phase + quadrature * quadrature);
+}
+
+// w.r for one frame of broadcast reference, summed in pairs so the adds don't form one long chain
+template <std::size_t TAPS>
+static inline simd::vfloat estimate_taps(const simd::vfloat* w, const float* r) {
+    using namespace simd;
+    vfloat sum[TAPS / 2];
+    for (std::size_t k = 0; k < TAPS / 2; ++k) {
+        sum[k] = add(mul(w[2 * k], load(r + 2 * k * WIDTH)), mul(w[2 * k + 1], load(r + (2 * k + 1) * WIDTH)));
+    }
+    for (std::size_t width = TAPS / 2; width > 1; width = (width + 1) / 2) {
+        for (std::size_t k = 0; k < width / 2; ++k) {
+            sum[k] = add(sum[2 * k], sum[2 * k + 1]);
+        }
+        if (width % 2 != 0) {
+            sum[width / 2] = sum[width - 1];
+        }
+    }
+    return sum[0];
+}
+
+template <std::size_t TAPS>
+void PowerLineCanceller::process_taps(const float* in, float* out, std::size_t frames, std::size_t stride) {
+    using namespace simd;
+
+    const std::size_t vector_channels = count - count % WIDTH;
+    const vfloat mu = set1(normalized_step);
+
+    for (std::size_t done = 0; done < frames; done += CHUNK_FRAMES) {
+        const std::size_t n = std::min(frames - done, CHUNK_FRAMES);
+        generate_reference(n);
+
+        // The tap count is fixed, so the weights stay in registers across the chunk, and each
+        // reference sample is one load, already broadcast, for both the estimate and the update.
+        // Every frame's update waits on that frame's error, so the loop is latency bound: two
+        // channel vectors go through it together, their chains overlapping.
+        std::size_t c = 0;
+        for (; c + 2 * WIDTH <= vector_channels; c += 2 * WIDTH) {
+            vfloat w0[TAPS], w1[TAPS];
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                w0[k] = load(weights + k * padded + c);
+                w1[k] = load(weights + k * padded + c + WIDTH);
+            }
+            const float* src = in + done * stride + c;
+            float* dst = out + done * stride + c;
+            const float* r = reference;
+            for (std::size_t f = 0; f < n; ++f, src += stride, dst += stride, r += TAPS * WIDTH) {
+                vfloat estimate0 = estimate_taps<TAPS>(w0, r);
+                vfloat estimate1 = estimate_taps<TAPS>(w1, r);
+                vfloat error0 = sub(load(src), estimate0);
+                vfloat error1 = sub(load(src + WIDTH), estimate1);
+                store(dst, error0);
+                store(dst + WIDTH, error1);
+                vfloat gain0 = mul(mu, error0);
+                vfloat gain1 = mul(mu, error1);
+                for (std::size_t k = 0; k < TAPS; ++k) {
+                    vfloat tap = load(r + k * WIDTH);
+                    w0[k] = add(w0[k], mul(gain0, tap));
+                    w1[k] = add(w1[k], mul(gain1, tap));
+                }
+            }
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                store(weights + k * padded + c, w0[k]);
+                store(weights + k * padded + c + WIDTH, w1[k]);
+            }
+        }
+        for (; c < vector_channels; c += WIDTH) {
+            vfloat w[TAPS];
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                w[k] = load(weights + k * padded + c);
+            }
+            const float* src = in + done * stride + c;
+            float* dst = out + done * stride + c;
+            const float* r = reference;
+            for (std::size_t f = 0; f < n; ++f, src += stride, dst += stride, r += TAPS * WIDTH) {
+                vfloat error = sub(load(src), estimate_taps<TAPS>(w, r));
+                store(dst, error);
+                vfloat gain = mul(mu, error);
+                for (std::size_t k = 0; k < TAPS; ++k) {
+                    w[k] = add(w[k], mul(gain, load(r + k * WIDTH)));
+                }
+            }
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                store(weights + k * padded + c, w[k]);
+            }
+        }
+
+        for (std::size_t c = vector_channels; c < count; ++c) {
+            float w[TAPS];
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                w[k] = weights[k * padded + c];
+            }
+            for (std::size_t f = 0; f < n; ++f) {
+                const float* r = reference + f * TAPS * WIDTH;
+                float estimate = w[0] * r[0];
+                for (std::size_t k = 1; k < TAPS; ++k) {
+                    estimate += w[k] * r[k * WIDTH];
+                }
+                float error = in[(done + f) * stride + c] - estimate;
+                out[(done + f) * stride + c] = error;
+                float gain = normalized_step * error;
+                for (std::size_t k = 0; k < TAPS; ++k) {
+                    w[k] += gain * r[k * WIDTH];
+                }
+            }
+            for (std::size_t k = 0; k < TAPS; ++k) {
+                weights[k * padded + c] = w[k];
+            }
+        }
+    }
+}
+
+void PowerLineCanceller::process(const float* in, float* out, std::size_t frames, std::size_t stride) {
+    switch (harmonic_count) {
+        case 1: process_taps<2>(in, out, frames, stride); break;
+        case 2: process_taps<4>(in, out, frames, stride); break;
+        case 3: process_taps<6>(in, out, frames, stride); break;
+        case 4: process_taps<8>(in, out, frames, stride); break;
+        case 5: process_taps<10>(in, out, frames, stride); break;
+        case 6: process_taps<12>(in, out, frames, stride); break;
+        case 7: process_taps<14>(in, out, frames, stride); break;
+        default: process_taps<2 * MAX_HARMONICS>(in, out, frames, stride); break;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef POWER_LINE_CANCELLER_H
+#define POWER_LINE_CANCELLER_H
+
+#include <cstddef>
+
+// Adaptive power-line interference canceller for a bank of channels (Widrow's adaptive noise
+// canceller). A reference oscillator runs at the mains frequency and each harmonic, as an
+// in-phase/quadrature pair, so there are two taps per harmonic. Each channel's NLMS filter
+// learns the amplitude and phase of its hum from those taps and subtracts the estimate:
+//   e = x - w.r,   w += step * e * r / |r|^2
+// Only the hum is removed, in notches about step * fs / (2 pi * harmonics) Hz wide, so the
+// EMG around it passes untouched. The notches follow changes in the hum within about
+// 2 * harmonics / step samples. The oscillator is shared by every channel, and each block
+// runs across channels with SIMD like FilterBank, on interleaved [frame][channel] data.
+// It costs about as much as a cascade of fixed notches at the same frequencies (the power-line
+// bench has it at 0.9-1.0x their speed): every tap is a multiply-add for the estimate and
+// another for the update. What it buys is the EMG left around the hum (-31 dB of error against
+// the clean signal, to -26 dB for Q 30 notches) and hum that drifts being followed.
+// State lives in caller-supplied storage (see storage_floats()), so the class is trivially
+// copyable and never allocates.
+class PowerLineCanceller {
+public:
+    static constexpr std::size_t MAX_HARMONICS = 8;
+    static constexpr std::size_t CHUNK_FRAMES = 64; // Frames of reference computed at a time
+
+    // Floats of storage a canceller of this shape needs
+    static std::size_t storage_floats(std::size_t channels, std::size_t harmonics);
+
+    PowerLineCanceller();
+
+    // - frequency: Mains frequency (Hz); every harmonic must be below Nyquist
+    // - harmonics: 1 .. MAX_HARMONICS (the fundamental counts as the first)
+    // - step: NLMS step size, 0 < step < 2 (0.01 is a good start)
+    // - storage: storage_floats(channels, harmonics) floats; weights start at zero
+    PowerLineCanceller(std::size_t channels, float sample_rate, float frequency, std::size_t harmonics, float step,
+                       float* storage);
+
+    // Zero the weights and restart the oscillator
+    void reset();
+
+    std::size_t channels() const { return count; }
+    std::size_t taps() const { return 2 * harmonic_count; }
+
+    // Cancel the hum in this canceller's channels of frames of stride samples each (in and out
+    // may alias)
+    void process(const float* in, float* out, std::size_t frames, std::size_t stride);
+    void process(const float* in, float* out, std::size_t frames) { process(in, out, frames, count); }
+
+    // A channel's current hum estimate, amplitude of harmonic h (0-based)
+    float amplitude(std::size_t channel, std::size_t harmonic) const;
+
+private:
+    std::size_t count;
+    std::size_t padded; // Channels rounded up to the vector width
+    std::size_t harmonic_count;
+    float normalized_step; // step / |r|^2
+    float* weights; // [tap][padded]: in-phase then quadrature, per harmonic
+    float* reference; // [frame][tap][lane] for one chunk, each sample broadcast across a vector
+    double phase_re[MAX_HARMONICS], phase_im[MAX_HARMONICS]; // Oscillator per harmonic
+    double rotate_re[MAX_HARMONICS], rotate_im[MAX_HARMONICS]; // Per-sample rotation
+
+    // Fill reference with the next frames oscillator samples
+    void generate_reference(std::size_t frames);
+
+    // process() for 2 * harmonic_count == TAPS
+    template <std::size_t TAPS>
+    void process_taps(const float* in, float* out, std::size_t frames, std::size_t stride);
+};
+
+#endif // POWER_LINE_CANCELLER_H
@@ -0,0 +1,380 @@
+#include "Recording.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char RECORDING_MAGIC[8] = { 'E', 'M', 'G', 'R', 'E', 'C', 0, 0 };
+const auto WRITER_IDLE_INTERVAL = std::chrono::milliseconds(2); // Writer thread polling period
+
+static std::size_t sample_size(SampleFormat format) {
+    return format == SampleFormat::Int16 ? sizeof(std::int16_t) : sizeof(float);
+}
+
+bool is_recording_path(const char* path) {
+    const char* extension = ".emgrec";
+    std::size_t path_length = std::strlen(path);
+    std::size_t extension_length = std::strlen(extension);
+    return path_length >= extension_length && std::strcmp(path + path_length - extension_length, extension) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// RecordingWriter
+
+RecordingWriter::RecordingWriter()
+    : file(nullptr), lossless(false), block_samples(0), current(0), has_current(false), fill(0), accepted(0),
+      running(false), failed(false), dropped(0) {
+    std::memset(&header, 0, sizeof(header));
+}
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::open(const char* path, const RecordingSettings& settings, bool lossless_writes) {
+    close();
+    if (settings.channels == 0 || settings.block_frames == 0 || !(settings.sample_rate > 0.0f)) {
+        LOG_ERROR("Invalid recording settings for %s", path);
+        return false;
+    }
+
+    file = std::fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR("Failed to create recording: %s", path);
+        return false;
+    }
+
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.header_size = (std::uint32_t)RECORDING_HEADER_SIZE;
+    header.sample_rate = settings.sample_rate;
+    header.channels = settings.channels;
+    header.format = settings.format;
+    header.layout = settings.layout;
+    header.block_frames = settings.block_frames;
+    header.int16_scale = settings.format == SampleFormat::Int16 ? settings.int16_full_scale / 32767.0f : 1.0f;
+    header.highpass_cutoff = settings.highpass_cutoff;
+    header.bandpass_low = settings.bandpass_low;
+    header.bandpass_high = settings.bandpass_high;
+    header.lowpass_cutoff = settings.lowpass_cutoff;
+    header.frames = 0; // Patched by close()
+
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        LOG_ERROR("Failed to write recording header: %s", path);
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    lossless = lossless_writes;
+    block_samples = (std::size_t)settings.block_frames * settings.channels;
+    buffers.assign(RECORDING_BUFFERS * block_samples, 0.0f);
+    std::uint32_t index;
+    while (filled.try_pop(index)) {}
+    while (available.try_pop(index)) {}
+    for (std::uint32_t i = 0; i < RECORDING_BUFFERS; ++i) {
+        available.try_push(i);
+    }
+    has_current = false;
+    fill = 0;
+    accepted = 0;
+    failed = false;
+    dropped = 0;
+
+    running = true;
+    thread = std::thread(&RecordingWriter::writer_loop, this);
+    return true;
+}
+
+// Take a free block for the producer; in lossless mode wait for the writer thread to release one
+bool RecordingWriter::acquire_block() {
+    while (!available.try_pop(current)) {
+        if (!lossless || failed.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    has_current = true;
+    fill = 0;
+    return true;
+}
+
+void RecordingWriter::submit_block() {
+    // Every block index is in exactly one of the two rings or held as current, so this never fails
+    filled.try_push(current);
+    has_current = false;
+}
+
+std::size_t RecordingWriter::write(const float* frames, std::size_t n) {
+    if (!file) {
+        return 0;
+    }
+
+    const std::size_t channels = header.channels;
+    const std::size_t block_frames = header.block_frames;
+    std::size_t done = 0;
+    while (done < n) {
+        if (!has_current && !acquire_block()) {
+            dropped.fetch_add(n - done, std::memory_order_relaxed);
+            break;
+        }
+        std::size_t count = std::min(n - done, block_frames - fill);
+        std::memcpy(&buffers[current * block_samples + fill * channels], frames + done * channels,
+                    count * channels * sizeof(float));
+        fill += count;
+        done += count;
+        if (fill == block_frames) {
+            submit_block();
+        }
+    }
+    accepted += done;
+    return done;
+}
+
+// Convert one block of interleaved floats to the on-disk layout and append it
+static bool write_block(FILE* file, const RecordingHeader& header, const float* block, std::vector<unsigned char>& encoded) {
+    const std::size_t channels = header.channels;
+    const std::size_t block_frames = header.block_frames;
+    const std::size_t count = channels * block_frames;
+    const bool per_channel = header.layout == SampleLayout::PerChannel && channels > 1;
+
+    if (header.format == SampleFormat::Float32 && !per_channel) {
+        return std::fwrite(block, sizeof(float), count, file) == count;
+    }
+
+    encoded.resize(count * sample_size(header.format));
+    if (header.format == SampleFormat::Float32) {
+        float* out = reinterpret_cast<float*>(encoded.data());
+        for (std::size_t c = 0; c < channels; ++c) {
+            for (std::size_t f = 0; f < block_frames; ++f) {
+                out[c * block_frames + f] = block[f * channels + c];
+            }
+        }
+    } else {
+        std::int16_t* out = reinterpret_cast<std::int16_t*>(encoded.data());
+        const float inverse_scale = 1.0f / header.int16_scale;
+        for (std::size_t f = 0; f < block_frames; ++f) {
+            for (std::size_t c = 0; c < channels; ++c) {
+                float scaled = std::round(block[f * channels + c] * inverse_scale);
+                scaled = std::max(-32767.0f, std::min(32767.0f, scaled));
+                std::size_t index = per_channel ? c * block_frames + f : f * channels + c;
+                out[index] = (std::int16_t)scaled;
+            }
+        }
+    }
+    return std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+}
+
+void RecordingWriter::writer_loop() {
+    std::vector<unsigned char> encoded;
+    for (;;) {
+        std::uint32_t index;
+        if (filled.try_pop(index)) {
+            if (!failed.load(std::memory_order_relaxed) && !write_block(file, header, &buffers[index * block_samples], encoded)) {
+                failed = true;
+            }
+            available.try_push(index);
+            continue;
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            break;
+        }
+        std::this_thread::sleep_for(WRITER_IDLE_INTERVAL);
+    }
+}
+
+bool RecordingWriter::close() {
+    if (!file) {
+        return true;
+    }
+
+    // Zero-pad and queue the partial block; header.frames records where the real data ends
+    if (has_current) {
+        if (fill > 0) {
+            std::fill(buffers.begin() + current * block_samples + fill * header.channels,
+                      buffers.begin() + (current + 1) * block_samples, 0.0f);
+            submit_block();
+        } else {
+            available.try_push(current);
+            has_current = false;
+        }
+    }
+
+    running.store(false, std::memory_order_release);
+    thread.join();
+
+    header.frames = accepted;
+    bool ok = !failed.load();
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    if (!ok) {
+        LOG_ERROR("Failed to write recording");
+    }
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// RecordingReader
+
+RecordingReader::RecordingReader() : base(nullptr), length(0), data(nullptr) {
+    std::memset(&header, 0, sizeof(header));
+}
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+// Map a whole file read-only; returns nullptr on failure
+static const unsigned char* map_file(const char* path, std::size_t& length) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return nullptr;
+    }
+    // The view keeps the mapping alive after its handle is closed
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        return nullptr;
+    }
+    length = (std::size_t)size.QuadPart;
+    return static_cast<const unsigned char*>(view);
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* view = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return nullptr;
+    }
+    length = (std::size_t)st.st_size;
+    return static_cast<const unsigned char*>(view);
+#endif
+}
+
+static void unmap_file(const unsigned char* view, std::size_t length) {
+#ifdef _WIN32
+    (void)length;
+    UnmapViewOfFile(view);
+#else
+    munmap(const_cast<unsigned char*>(view), length);
+#endif
+}
+
+bool RecordingReader::open(const char* path) {
+    close();
+
+    std::size_t mapped_length = 0;
+    const unsigned char* view = map_file(path, mapped_length);
+    if (!view) {
+        LOG_ERROR("Failed to map recording: %s", path);
+        return false;
+    }
+
+    RecordingHeader candidate;
+    bool valid = mapped_length >= sizeof(candidate);
+    if (valid) {
+        std::memcpy(&candidate, view, sizeof(candidate));
+        // Samples are read in place through float and int16 pointers, so blocks must start aligned
+        valid = std::memcmp(candidate.magic, RECORDING_MAGIC, sizeof(candidate.magic)) == 0 &&
+                candidate.version == RECORDING_VERSION && candidate.header_size >= RECORDING_HEADER_SIZE &&
+                candidate.header_size % alignof(float) == 0 && candidate.header_size <= mapped_length &&
+                candidate.channels > 0 && candidate.block_frames > 0 &&
+                (candidate.format == SampleFormat::Float32 || candidate.format == SampleFormat::Int16) &&
+                (candidate.layout == SampleLayout::Interleaved || candidate.layout == SampleLayout::PerChannel);
+    }
+    if (!valid) {
+        LOG_ERROR("Not a supported recording: %s", path);
+        unmap_file(view, mapped_length);
+        return false;
+    }
+
+    // Only whole blocks are readable; an unfinished recording keeps every block that reached the disk
+    std::uint64_t block_bytes = (std::uint64_t)candidate.block_frames * candidate.channels * sample_size(candidate.format);
+    std::uint64_t complete_frames = (mapped_length - candidate.header_size) / block_bytes * candidate.block_frames;
+    if (candidate.frames == 0 || candidate.frames > complete_frames) {
+        if (candidate.frames > complete_frames) {
+            LOG_WARNING("Recording %s is truncated; reading %llu of %llu frames", path,
+                        (unsigned long long)complete_frames, (unsigned long long)candidate.frames);
+        }
+        candidate.frames = complete_frames;
+    }
+
+    header = candidate;
+    base = view;
+    length = mapped_length;
+    data = view + header.header_size;
+    return true;
+}
+
+void RecordingReader::close() {
+    if (base) {
+        unmap_file(base, length);
+    }
+    base = nullptr;
+    data = nullptr;
+    length = 0;
+    std::memset(&header, 0, sizeof(header));
+}
+
+const float* RecordingReader::channel_span(std::uint64_t frame, std::uint32_t channel, std::size_t& run) const {
+    run = 0;
+    if (header.format != SampleFormat::Float32 || frame >= header.frames) {
+        return nullptr;
+    }
+    const float* samples = reinterpret_cast<const float*>(data);
+    if (header.channels == 1) {
+        // Blocks of a single channel follow each other with no gaps
+        run = (std::size_t)(header.frames - frame);
+        return samples + frame;
+    }
+    if (header.layout != SampleLayout::PerChannel) {
+        return nullptr;
+    }
+    std::uint64_t block = frame / header.block_frames;
+    std::uint64_t within = frame % header.block_frames;
+    run = (std::size_t)std::min<std::uint64_t>(header.block_frames - within, header.frames - frame);
+    return samples + (block * header.channels + channel) * header.block_frames + within;
+}
+
+std::size_t RecordingReader::read_channel(std::uint32_t channel, std::uint64_t frame, float* out, std::size_t n) const {
+    if (frame >= header.frames || channel >= header.channels) {
+        return 0;
+    }
+    std::size_t count = (std::size_t)std::min<std::uint64_t>(n, header.frames - frame);
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = sample(frame + i, channel);
+    }
+    return count;
+}
@@ -0,0 +1,183 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+
+// On-disk recording format (.emgrec):
+// a 128-byte RecordingHeader, then fixed-size blocks of block_frames frames each.
+// A block is either interleaved ([frame][channel]) or per-channel ([channel][frame]),
+// stored as float32 or as int16 scaled by int16_scale. The last block is zero padded;
+// header.frames gives the real length. All fields are little-endian (native on every target).
+
+const std::uint32_t RECORDING_VERSION = 1;
+const std::size_t RECORDING_HEADER_SIZE = 128;
+const std::uint32_t RECORDING_BLOCK_FRAMES = 1024; // Default frames per block (~0.5 s at 2000 Hz)
+const std::size_t RECORDING_BUFFERS = 16; // Blocks queued between the producer and the writer thread
+
+// Channel order of processed recordings written by the viewer and by batch mode; a viewer
+// recording of several source channels repeats it for each, [frame][source channel][stream]
+enum RecordedStream {
+    STREAM_RAW,
+    STREAM_HIGHPASSED,
+    STREAM_BANDPASSED,
+    STREAM_RECTIFIED,
+    STREAM_ENVELOPE,
+    STREAM_COUNT
+};
+
+enum class SampleFormat : std::uint32_t {
+    Float32 = 0,
+    Int16 = 1
+};
+
+enum class SampleLayout : std::uint32_t {
+    Interleaved = 0,
+    PerChannel = 1
+};
+
+struct RecordingHeader {
+    char magic[8]; // "EMGREC\0\0"
+    std::uint32_t version;
+    std::uint32_t header_size; // Bytes before the first block
+    float sample_rate; // Hz
+    std::uint32_t channels;
+    SampleFormat format;
+    SampleLayout layout;
+    std::uint32_t block_frames;
+    float int16_scale; // Int16 only: sample = stored value * int16_scale
+    // Filter settings in effect when the recording was made (0 if not applicable)
+    float highpass_cutoff;
+    float bandpass_low;
+    float bandpass_high;
+    float lowpass_cutoff;
+    std::uint64_t frames; // Frames recorded; 0 if the writer never closed (reader infers it from the file size)
+    char reserved[64];
+};
+
+static_assert(sizeof(RecordingHeader) == RECORDING_HEADER_SIZE, "RecordingHeader must stay 128 bytes");
+
+// Everything the writer needs to know up front
+struct RecordingSettings {
+    float sample_rate = 2000.0f;
+    std::uint32_t channels = 1;
+    SampleFormat format = SampleFormat::Float32;
+    SampleLayout layout = SampleLayout::Interleaved;
+    std::uint32_t block_frames = RECORDING_BLOCK_FRAMES;
+    float int16_full_scale = 1.0f; // Int16 only: amplitude that maps to +/-32767 (larger values clip)
+    float highpass_cutoff = 0.0f;
+    float bandpass_low = 0.0f;
+    float bandpass_high = 0.0f;
+    float lowpass_cutoff = 0.0f;
+};
+
+// Streams interleaved float frames to a recording file. The producer copies frames into
+// preallocated block buffers; a background thread converts full blocks to the on-disk
+// format and writes them, so the producer never touches the file.
+// One thread calls write(), and close() is called from that same thread.
+class RecordingWriter {
+private:
+    FILE* file;
+    RecordingHeader header;
+    bool lossless; // Wait for a free buffer instead of dropping frames when the writer falls behind
+    std::size_t block_samples; // block_frames * channels
+
+    std::vector<float> buffers; // RECORDING_BUFFERS blocks of interleaved frames
+    SpscRing<std::uint32_t, RECORDING_BUFFERS> filled; // Producer -> writer thread
+    SpscRing<std::uint32_t, RECORDING_BUFFERS> available; // Writer thread -> producer
+
+    // Producer state
+    std::uint32_t current; // Block being filled
+    bool has_current;
+    std::size_t fill; // Frames in the current block
+    std::uint64_t accepted; // Frames accepted so far
+
+    std::atomic<bool> running;
+    std::atomic<bool> failed;
+    std::atomic<std::uint64_t> dropped;
+    std::thread thread;
+
+    void writer_loop();
+    bool acquire_block();
+    void submit_block();
+
+public:
+    RecordingWriter();
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    // Create path and start the writer thread. With lossless set, write() blocks while
+    // every buffer is queued (for offline use); otherwise excess frames are dropped and counted.
+    bool open(const char* path, const RecordingSettings& settings, bool lossless = false);
+
+    // Queue n interleaved frames; returns how many were accepted
+    std::size_t write(const float* frames, std::size_t n);
+
+    // Flush the partial block, stop the writer thread and finalize the header; returns false on any I/O error
+    bool close();
+
+    bool is_open() const { return file != nullptr; }
+    std::uint64_t frames() const { return accepted; }
+    std::uint64_t dropped_frames() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+// Read-only, memory-mapped view of a recording. Samples are read straight from the
+// mapping; nothing is loaded or copied up front, so seeking anywhere is free.
+class RecordingReader {
+private:
+    RecordingHeader header;
+    const unsigned char* base; // Start of the mapping
+    std::size_t length; // Bytes mapped
+    const unsigned char* data; // First block
+
+public:
+    RecordingReader();
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    // Map path and validate its header; returns false (and logs) if it isn't a usable recording
+    bool open(const char* path);
+    void close();
+
+    bool is_open() const { return base != nullptr; }
+    const RecordingHeader& info() const { return header; }
+    std::uint64_t frames() const { return header.frames; }
+    std::uint32_t channels() const { return header.channels; }
+    float sample_rate() const { return header.sample_rate; }
+
+    // One sample, decoded in place (frame < frames(), channel < channels())
+    float sample(std::uint64_t frame, std::uint32_t channel) const {
+        std::uint64_t block = frame / header.block_frames;
+        std::uint64_t within = frame % header.block_frames;
+        std::uint64_t index = header.layout == SampleLayout::Interleaved
+            ? within * header.channels + channel
+            : channel * (std::uint64_t)header.block_frames + within;
+        std::uint64_t element = block * header.block_frames * header.channels + index;
+        if (header.format == SampleFormat::Float32) {
+            return reinterpret_cast<const float*>(data)[element];
+        }
+        return reinterpret_cast<const std::int16_t*>(data)[element] * header.int16_scale;
+    }
+
+    // Pointer into the mapping for float32 data that is stored contiguously for this channel
+    // (single-channel or per-channel recordings), or nullptr. run receives the number of
+    // consecutive frames available from that pointer.
+    const float* channel_span(std::uint64_t frame, std::uint32_t channel, std::size_t& run) const;
+
+    // Decode up to n samples of one channel starting at frame; returns the number written
+    std::size_t read_channel(std::uint32_t channel, std::uint64_t frame, float* out, std::size_t n) const;
+};
+
+// True if path names a .emgrec recording
+bool is_recording_path(const char* path);
+
+#endif // RECORDING_H
@@ -0,0 +1,63 @@
+#ifndef RUNNING_MAX_H
+#define RUNNING_MAX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Maximum over the most recent `window` samples, updated in amortized O(1) per sample.
+// Keeps a monotonic deque of candidates (decreasing values, increasing age) in a fixed
+// power-of-two ring indexed with a mask, so no allocation happens after construction. Until `window` samples have been
+// pushed, the maximum covers only the samples seen so far (0 if none).
+class RunningMax {
+private:
+    struct Entry {
+        std::uint64_t sequence; // Sample number the value was pushed at
+        float value;
+    };
+
+    std::size_t window;
+    std::size_t mask; // Ring length (at least window, a power of two) - 1
+    std::vector<Entry> entries; // Ring of at most `window` candidates
+    std::size_t front; // Ring position of the oldest (largest) candidate
+    std::size_t count; // Number of candidates in the deque
+    std::uint64_t next_sequence;
+
+    // Smallest power of two holding window entries
+    static std::size_t ring_length(std::size_t window) {
+        std::size_t length = 1;
+        while (length < window) {
+            length <<= 1;
+        }
+        return length;
+    }
+
+public:
+    explicit RunningMax(std::size_t window)
+        : window(window), mask(ring_length(window) - 1), entries(mask + 1), front(0), count(0), next_sequence(0) {}
+
+    void push(float value) {
+        // Anything not larger than the new value can never be the maximum again
+        while (count > 0 && entries[(front + count - 1) & mask].value <= value) {
+            --count;
+        }
+        // Drop the oldest candidate once it slides out of the window
+        if (count > 0 && entries[front].sequence + window <= next_sequence) {
+            front = (front + 1) & mask;
+            --count;
+        }
+        entries[(front + count) & mask] = { next_sequence, value };
+        ++count;
+        ++next_sequence;
+    }
+
+    float max() const { return count > 0 ? entries[front].value : 0.0f; }
+
+    void reset() {
+        count = 0;
+        front = 0;
+        next_sequence = 0;
+    }
+};
+
+#endif // RUNNING_MAX_H
@@ -0,0 +1,25 @@
+#include "SampleSource.h"
+#include <algorithm>
+
+SyntheticSource::SyntheticSource(std::size_t channels, float sample_rate, std::uint64_t seed, const EMGSignalParams& params,
+                                 std::size_t block_frames)
+    : generator(channels, sample_rate, seed, params), rate(sample_rate), block_frames(block_frames),
+      block(block_frames * channels), origin(clock::now()), produced(0) {}
+
+const float* SyntheticSource::acquire(std::size_t& frames) {
+    long long due = (long long)(std::chrono::duration<double>(clock::now() - origin).count() * rate);
+    if (produced >= due) {
+        frames = 0;
+        return nullptr;
+    }
+    frames = (std::size_t)std::min<long long>(due - produced, (long long)block_frames);
+    generator.generate(block.data(), frames);
+    produced += (long long)frames;
+    return block.data();
+}
+
+void SyntheticSource::resync() {
+    // Restart the clock so resuming doesn't try to catch up on the skipped interval
+    origin = clock::now();
+    produced = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef SAMPLE_SOURCE_H
+#define SAMPLE_SOURCE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "EMGGenerator.h"
+
+// Where the acquisition thread gets its samples. Sources lend out blocks of interleaved
+// frames ([frame][channel]) from their own storage, so the filter chain reads them in
+// place whether they were just generated or just received from the network.
+// All calls come from the acquisition thread.
+class SampleSource {
+public:
+    virtual ~SampleSource() {}
+
+    virtual std::size_t channels() const = 0;
+    virtual float sample_rate() const = 0;
+
+    // Borrow the next block of frames that is ready now, or return nullptr if there is none yet.
+    // The block stays valid until release(); call release() before the next acquire().
+    virtual const float* acquire(std::size_t& frames) = 0;
+    virtual void release() = 0;
+
+    // Discard anything that built up while the consumer wasn't reading (e.g. while paused)
+    virtual void resync() = 0;
+};
+
+// The synthetic EMG generator as a source. It keeps its own real-time clock and hands out
+// every frame that has come due since the last call, in blocks of up to block_frames.
+class SyntheticSource : public SampleSource {
+private:
+    typedef std::chrono::steady_clock clock;
+
+    EMGGenerator generator;
+    float rate;
+    std::size_t block_frames;
+    std::vector<float> block;
+
+    // Frames are produced against a fixed origin so scheduling jitter never accumulates
+    clock::time_point origin;
+    long long produced;
+
+public:
+    SyntheticSource(std::size_t channels, float sample_rate, std::uint64_t seed, const EMGSignalParams& params,
+                    std::size_t block_frames);
+
+    std::size_t channels() const override { return generator.channels(); }
+    float sample_rate() const override { return rate; }
+    const float* acquire(std::size_t& frames) override;
+    void release() override {}
+    void resync() override;
+};
+
+#endif // SAMPLE_SOURCE_H
@@ -0,0 +1,242 @@
+#include "Session.h"
+#include "Logger.h"
+#include "PolyphaseDecimator.h"
+#include "PowerLineCanceller.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+const std::size_t MAX_CHANNELS = 65535; // Matches the network packet header's channel field
+const std::size_t CONFIG_LINE_SIZE = 256; // Longest config file line accepted
+
+static const char* const SESSION_OPTIONS[] = {
+    "sample-rate", "channels", "display-channel", "window", "highpass", "bandpass-low", "bandpass-high",
+    "lowpass", "envelope", "envelope-window", "mains", "mains-harmonics", "mains-step", "envelope-rate",
+    "onset", "offset", "onset-hold", "onset-signal",
+};
+
+bool is_session_option(const char* name) {
+    for (const char* option : SESSION_OPTIONS) {
+        if (std::strcmp(name, option) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parse a positive number; returns false (and logs) if text isn't one
+static bool parse_positive(const char* name, const char* text, float& value) {
+    char* end;
+    float parsed = std::strtof(text, &end);
+    if (end == text || *end != '\0' || !(parsed > 0.0f) || std::isinf(parsed)) {
+        LOG_ERROR("Invalid value for %s: %s", name, text);
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Parse a count in [minimum, MAX_CHANNELS]; returns false (and logs) if text isn't one
+static bool parse_count(const char* name, const char* text, std::size_t minimum, std::size_t& value) {
+    char* end;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < (long)minimum || parsed > (long)MAX_CHANNELS) {
+        LOG_ERROR("Invalid value for %s: %s", name, text);
+        return false;
+    }
+    value = (std::size_t)parsed;
+    return true;
+}
+
+bool set_session_option(SessionConfig& config, const char* name, const char* value) {
+    if (std::strcmp(name, "sample-rate") == 0) {
+        return parse_positive(name, value, config.sample_rate);
+    } else if (std::strcmp(name, "channels") == 0) {
+        return parse_count(name, value, 1, config.channels);
+    } else if (std::strcmp(name, "display-channel") == 0) {
+        return parse_count(name, value, 0, config.display_channel);
+    } else if (std::strcmp(name, "window") == 0) {
+        return parse_positive(name, value, config.display_seconds);
+    } else if (std::strcmp(name, "highpass") == 0) {
+        return parse_positive(name, value, config.highpass_cutoff);
+    } else if (std::strcmp(name, "bandpass-low") == 0) {
+        return parse_positive(name, value, config.bandpass_low);
+    } else if (std::strcmp(name, "bandpass-high") == 0) {
+        return parse_positive(name, value, config.bandpass_high);
+    } else if (std::strcmp(name, "lowpass") == 0) {
+        return parse_positive(name, value, config.lowpass_cutoff);
+    } else if (std::strcmp(name, "envelope") == 0) {
+        if (!parse_envelope_type(value, config.envelope)) {
+            LOG_ERROR("Unknown envelope type: %s (expected lowpass, average or rms)", value);
+            return false;
+        }
+        return true;
+    } else if (std::strcmp(name, "envelope-window") == 0) {
+        float window_ms;
+        if (!parse_positive(name, value, window_ms)) {
+            return false;
+        }
+        config.envelope_window = window_ms / 1000.0f;
+        return true;
+    } else if (std::strcmp(name, "mains") == 0) {
+        return parse_positive(name, value, config.mains_frequency);
+    } else if (std::strcmp(name, "mains-harmonics") == 0) {
+        return parse_count(name, value, 1, config.mains_harmonics);
+    } else if (std::strcmp(name, "mains-step") == 0) {
+        return parse_positive(name, value, config.mains_step);
+    } else if (std::strcmp(name, "envelope-rate") == 0) {
+        return parse_positive(name, value, config.envelope_rate);
+    } else if (std::strcmp(name, "onset") == 0) {
+        return parse_positive(name, value, config.onset_threshold);
+    } else if (std::strcmp(name, "offset") == 0) {
+        return parse_positive(name, value, config.offset_threshold);
+    } else if (std::strcmp(name, "onset-hold") == 0) {
+        float hold_ms;
+        if (!parse_positive(name, value, hold_ms)) {
+            return false;
+        }
+        config.onset_hold = hold_ms / 1000.0f;
+        return true;
+    } else if (std::strcmp(name, "onset-signal") == 0) {
+        if (std::strcmp(value, "envelope") != 0 && std::strcmp(value, "tkeo") != 0) {
+            LOG_ERROR("Unknown onset signal: %s (expected envelope or tkeo)", value);
+            return false;
+        }
+        config.onset_tkeo = std::strcmp(value, "tkeo") == 0;
+        return true;
+    }
+    LOG_ERROR("Unknown session option: %s", name);
+    return false;
+}
+
+// Trim spaces and tabs from both ends in place
+static char* trim(char* text) {
+    while (*text == ' ' || *text == '\t') {
+        ++text;
+    }
+    char* end = text + std::strlen(text);
+    while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        --end;
+    }
+    *end = '\0';
+    return text;
+}
+
+bool load_session_config(const char* path, SessionConfig& config) {
+    FILE* file = std::fopen(path, "r");
+    if (!file) {
+        LOG_ERROR("Failed to open config file: %s", path);
+        return false;
+    }
+
+    bool ok = true;
+    char line[CONFIG_LINE_SIZE];
+    for (int number = 1; std::fgets(line, sizeof(line), file); ++number) {
+        if (char* comment = std::strchr(line, '#')) {
+            *comment = '\0';
+        }
+        char* text = trim(line);
+        if (*text == '\0') {
+            continue;
+        }
+        char* equals = std::strchr(text, '=');
+        if (!equals) {
+            LOG_ERROR("%s:%d: expected name = value", path, number);
+            ok = false;
+            continue;
+        }
+        *equals = '\0';
+        if (!set_session_option(config, trim(text), trim(equals + 1))) {
+            LOG_ERROR("%s:%d: invalid setting", path, number);
+            ok = false;
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+bool validate_session_config(const SessionConfig& config) {
+    bool ok = true;
+    const float nyquist = config.sample_rate / 2.0f;
+    if (config.display_channel >= config.channels) {
+        LOG_ERROR("display-channel %zu is out of range for %zu channels", config.display_channel, config.channels);
+        ok = false;
+    }
+    if (config.bandpass_low >= config.bandpass_high) {
+        LOG_ERROR("bandpass-low (%g Hz) must be below bandpass-high (%g Hz)", config.bandpass_low, config.bandpass_high);
+        ok = false;
+    }
+    const float cutoffs[] = { config.highpass_cutoff, config.bandpass_high, config.lowpass_cutoff };
+    const char* names[] = { "highpass", "bandpass-high", "lowpass" };
+    for (int i = 0; i < 3; ++i) {
+        if (cutoffs[i] >= nyquist) {
+            LOG_ERROR("%s (%g Hz) must be below half the sample rate (%g Hz)", names[i], cutoffs[i], nyquist);
+            ok = false;
+        }
+    }
+    if (config.mains_frequency > 0.0f) {
+        if (config.mains_harmonics > PowerLineCanceller::MAX_HARMONICS) {
+            LOG_ERROR("mains-harmonics %zu is above the maximum of %zu", config.mains_harmonics,
+                      PowerLineCanceller::MAX_HARMONICS);
+            ok = false;
+        } else if (config.mains_frequency * config.mains_harmonics >= nyquist) {
+            LOG_ERROR("mains harmonic %zu (%g Hz) must be below half the sample rate (%g Hz)", config.mains_harmonics,
+                      config.mains_frequency * config.mains_harmonics, nyquist);
+            ok = false;
+        }
+        if (config.mains_step >= 2.0f) {
+            LOG_ERROR("mains-step (%g) must be below 2", config.mains_step);
+            ok = false;
+        }
+    }
+    std::size_t up, down;
+    if (config.envelope_rate > 0.0f && !PolyphaseDecimator::ratio(config.sample_rate, config.envelope_rate, up, down)) {
+        LOG_ERROR("envelope-rate (%g Hz) must be a whole number of Hz below the sample rate (%g Hz), in a ratio "
+                  "that reduces to at most %zu:n",
+                  config.envelope_rate, config.sample_rate, PolyphaseDecimator::MAX_PHASES);
+        ok = false;
+    }
+    if (config.onset_threshold > 0.0f && config.offset_threshold > config.onset_threshold) {
+        LOG_ERROR("offset (%g) must not be above onset (%g)", config.offset_threshold, config.onset_threshold);
+        ok = false;
+    }
+    if (std::lround(config.display_seconds * config.sample_rate) < 2) {
+        LOG_ERROR("window (%g s) holds fewer than 2 samples", config.display_seconds);
+        ok = false;
+    }
+    return ok;
+}
+
+std::size_t session_display_samples(const SessionConfig& config) {
+    long samples = std::lround(config.display_seconds * config.sample_rate);
+    return samples > 2 ? (std::size_t)samples : 2;
+}
+
+std::size_t session_envelope_samples(const SessionConfig& config) {
+    if (config.envelope_rate <= 0.0f) {
+        return 0;
+    }
+    long samples = std::lround(config.display_seconds * config.envelope_rate);
+    return samples > 2 ? (std::size_t)samples : 2;
+}
+
+void log_session_config(const SessionConfig& config) {
+    LOG_INFO("Session: %zu channel(s) at %g Hz, showing channel %zu over %g s", config.channels, config.sample_rate,
+             config.display_channel, config.display_seconds);
+    LOG_INFO("Filters: high-pass %g Hz, band-pass %g-%g Hz, %s envelope", config.highpass_cutoff, config.bandpass_low,
+             config.bandpass_high, envelope_type_name(config.envelope));
+    if (config.mains_frequency > 0.0f) {
+        LOG_INFO("Power-line canceller: %g Hz and %zu harmonic(s), NLMS step %g", config.mains_frequency,
+                 config.mains_harmonics, config.mains_step);
+    }
+    if (config.envelope_rate > 0.0f) {
+        LOG_INFO("Envelope decimated to %g Hz for display", config.envelope_rate);
+    }
+    if (config.onset_threshold > 0.0f) {
+        LOG_INFO("Onset detector on the %s: onset above %g, offset below %g, held %g ms",
+                 config.onset_tkeo ? "TKEO" : "envelope", config.onset_threshold,
+                 config.offset_threshold > 0.0f ? config.offset_threshold : config.onset_threshold / 2.0f,
+                 config.onset_hold * 1000.0f);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <cstddef>
+#include "Envelope.h"
+
+// Everything about a viewer session that sizes its buffers and designs its filters, fixed at
+// startup (defaults match the original single-channel 2 kHz build). Set from a config file
+// and/or the command line with the same option names:
+// - sample-rate: Hz
+// - channels: Channels per frame from the source (synthetic or network), each filtered
+// - display-channel: Channel shown and analyzed (0-based); recordings hold every channel, and
+//   playback shows this one
+// - window: Seconds of signal on screen
+// - highpass, bandpass-low, bandpass-high, lowpass: Cutoffs (Hz); highpass and bandpass-high
+//   are the starting points the arrow keys adjust
+// - envelope: lowpass, average or rms
+// - envelope-window: Moving-average/RMS window (ms)
+// - mains: Power-line frequency (Hz) to cancel adaptively ahead of the filters; off unless set
+// - mains-harmonics: Harmonics cancelled, counting the fundamental (two NLMS taps each)
+// - mains-step: NLMS step size, between 0 and 2
+// - envelope-rate: Rate (Hz) the envelope is decimated to for display; full rate unless set
+// - onset: Threshold for muscle onset events, in units of onset-signal; no detector unless set
+// - offset: Threshold the signal must drop below again for an offset (default half of onset)
+// - onset-hold: Time (ms) past a threshold before the event fires
+// - onset-signal: envelope (default), or tkeo for the Teager-Kaiser energy of the band-passed
+//   signal, whose thresholds are in squared units. On the envelope, events also wait out the
+//   envelope filter's group delay (~50 ms mean, 75 ms worst with the default 2 Hz low-pass,
+//   against 6-12 ms for tkeo): choose tkeo to meet a latency target of a few ms
+struct SessionConfig {
+    float sample_rate = 2000.0f;
+    std::size_t channels = 1;
+    std::size_t display_channel = 0;
+    float display_seconds = 0.5f;
+    float highpass_cutoff = 5.0f;
+    float bandpass_low = 5.0f;
+    float bandpass_high = 50.0f;
+    float lowpass_cutoff = 2.0f;
+    EnvelopeType envelope = EnvelopeType::LowPass;
+    float envelope_window = 0.1f; // Seconds
+    float mains_frequency = 0.0f; // 0: no power-line canceller
+    std::size_t mains_harmonics = 3;
+    float mains_step = 0.01f;
+    float envelope_rate = 0.0f; // 0: envelope stays at sample_rate
+    float onset_threshold = 0.0f; // 0: no onset detector
+    float offset_threshold = 0.0f; // 0: half of onset_threshold
+    float onset_hold = 0.005f; // Seconds
+    bool onset_tkeo = false;
+};
+
+// Whether name (without leading dashes) is a session option
+bool is_session_option(const char* name);
+
+// Set one option from its text value; logs and returns false for an unknown name or a bad value
+bool set_session_option(SessionConfig& config, const char* name, const char* value);
+
+// Read "name = value" lines into config; blank lines and anything after '#' are ignored.
+// Options the file doesn't mention keep their current values.
+bool load_session_config(const char* path, SessionConfig& config);
+
+// Check the options are consistent with each other (cutoffs below Nyquist, display channel in
+// range, ...), logging every problem found
+bool validate_session_config(const SessionConfig& config);
+
+// Samples in the display window, at least 2
+std::size_t session_display_samples(const SessionConfig& config);
+
+// Envelope samples in the display window at envelope-rate (at least 2), or 0 at full rate
+std::size_t session_envelope_samples(const SessionConfig& config);
+
+// Log the settings in effect
+void log_session_config(const SessionConfig& config);
+
+#endif // SESSION_H
@@ -0,0 +1,231 @@
+#include "SignalRenderer.h"
+#include "Logger.h"
+#include <algorithm>
+#include <string>
+
+const float DISPLAY_RANGE = 0.5f; // Amplitude range to prevent overlap between traces
+
+// Vertex shader body shared by both GLSL versions; SLOT is the vertex's index in the doubled ring
+static const char* TRACE_VERTEX_BODY = R"(
+uniform float u_head;
+uniform float u_x_scale;
+uniform float u_y_scale;
+uniform float u_y_offset;
+attribute float a_value;
+
+void main() {
+    float x = -1.0 + (SLOT - u_head) * u_x_scale;
+    float y = u_y_offset + a_value * u_y_scale;
+    gl_Position = gl_ModelViewProjectionMatrix * vec4(x, y, 0.0, 1.0);
+}
+)";
+
+static const char* TRACE_FRAGMENT_SOURCE = R"(
+#version 120
+uniform vec3 u_color;
+
+void main() {
+    gl_FragColor = vec4(u_color, 1.0);
+}
+)";
+
+// Whether a window of capacity samples is drawn decimated at this many columns
+static bool is_decimated_shape(std::size_t capacity, std::size_t columns) {
+    return columns > 0 && capacity > 2 * columns;
+}
+
+std::size_t SignalRenderer::storage_floats(std::size_t capacity, std::size_t traces, std::size_t columns) {
+    bool decimated = is_decimated_shape(capacity, columns);
+    std::size_t vertices = decimated ? 2 * columns : 2 * capacity;
+    return traces * (vertices + MinMaxPyramid::storage_floats(decimated ? capacity : 1));
+}
+
+SignalRenderer::SignalRenderer(std::size_t capacity, const std::vector<TraceStyle>& styles, std::size_t columns,
+                               float* storage)
+    : capacity(capacity), columns(columns), decimated(is_decimated_shape(capacity, columns)),
+      zero_line_vbo(0), program(0), slot_vbo(0),
+      u_head(-1), u_x_scale(-1), u_y_scale(-1), u_y_offset(-1), u_color(-1) {
+    if (!storage) {
+        owned.resize(storage_floats(capacity, styles.size(), columns));
+        storage = owned.data();
+    }
+    // Each trace's vertex data, then its pyramid
+    const std::size_t pyramid_capacity = decimated ? capacity : 1;
+    for (const TraceStyle& style : styles) {
+        float* values = storage;
+        std::fill(values, values + vertex_floats(), 0.0f);
+        storage += vertex_floats();
+        Trace trace = { style, 0, values, 0, 0, MinMaxPyramid(pyramid_capacity, storage) };
+        storage += MinMaxPyramid::storage_floats(pyramid_capacity);
+        traces.push_back(std::move(trace));
+    }
+}
+
+bool SignalRenderer::build_shader() {
+    const char* attributes[] = { "a_value", "a_slot", nullptr };
+
+    // GLSL 1.30 provides gl_VertexID, so no per-vertex x data is needed at all
+    std::string modern = std::string("#version 130\n#define SLOT float(gl_VertexID)\n") + TRACE_VERTEX_BODY;
+    program = gl::build_program(modern.c_str(), TRACE_FRAGMENT_SOURCE, attributes);
+
+    if (!program) {
+        // OpenGL 2.1 drivers: read the vertex index from a static attribute shared by every trace
+        LOG_WARNING("gl_VertexID unavailable, falling back to a vertex index attribute");
+        std::string legacy = std::string("#version 120\nattribute float a_slot;\n#define SLOT a_slot\n") + TRACE_VERTEX_BODY;
+        program = gl::build_program(legacy.c_str(), TRACE_FRAGMENT_SOURCE, attributes);
+        if (!program) {
+            return false;
+        }
+
+        std::vector<float> slots(vertex_floats());
+        for (std::size_t k = 0; k < slots.size(); ++k) {
+            slots[k] = (float)k;
+        }
+        gl::GenBuffers(1, &slot_vbo);
+        gl::BindBuffer(GL_ARRAY_BUFFER, slot_vbo);
+        gl::BufferData(GL_ARRAY_BUFFER, slots.size() * sizeof(float), slots.data(), GL_STATIC_DRAW);
+    }
+
+    u_head = gl::GetUniformLocation(program, "u_head");
+    u_x_scale = gl::GetUniformLocation(program, "u_x_scale");
+    u_y_scale = gl::GetUniformLocation(program, "u_y_scale");
+    u_y_offset = gl::GetUniformLocation(program, "u_y_offset");
+    u_color = gl::GetUniformLocation(program, "u_color");
+    return true;
+}
+
+bool SignalRenderer::init() {
+    if (!gl::load_functions() || !build_shader()) {
+        return false;
+    }
+
+    for (Trace& trace : traces) {
+        gl::GenBuffers(1, &trace.vbo);
+        gl::BindBuffer(GL_ARRAY_BUFFER, trace.vbo);
+        gl::BufferData(GL_ARRAY_BUFFER, vertex_floats() * sizeof(float), trace.values, GL_DYNAMIC_DRAW);
+    }
+
+    std::vector<float> zero_lines;
+    for (const Trace& trace : traces) {
+        float line[4] = { -1.0f, trace.style.y_offset, 1.0f, trace.style.y_offset };
+        zero_lines.insert(zero_lines.end(), line, line + 4);
+    }
+    gl::GenBuffers(1, &zero_line_vbo);
+    gl::BindBuffer(GL_ARRAY_BUFFER, zero_line_vbo);
+    gl::BufferData(GL_ARRAY_BUFFER, zero_lines.size() * sizeof(float), zero_lines.data(), GL_STATIC_DRAW);
+
+    gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GL_CHECK("SignalRenderer::init");
+    return true;
+}
+
+void SignalRenderer::shutdown() {
+    for (Trace& trace : traces) {
+        if (trace.vbo) {
+            gl::DeleteBuffers(1, &trace.vbo);
+            trace.vbo = 0;
+        }
+    }
+    if (zero_line_vbo) {
+        gl::DeleteBuffers(1, &zero_line_vbo);
+        zero_line_vbo = 0;
+    }
+    if (slot_vbo) {
+        gl::DeleteBuffers(1, &slot_vbo);
+        slot_vbo = 0;
+    }
+    if (program) {
+        gl::DeleteProgram(program);
+        program = 0;
+    }
+}
+
+void SignalRenderer::write(std::size_t index, std::size_t slot, float value) {
+    Trace& trace = traces[index];
+    if (decimated) {
+        trace.pyramid.push(value);
+        return;
+    }
+    trace.values[slot] = value;
+    trace.values[slot + capacity] = value;
+
+    // Writes arrive in ring order, so the dirty region stays one run of slots
+    if (trace.dirty_count == 0) {
+        trace.dirty_start = slot;
+        trace.dirty_count = 1;
+    } else if (trace.dirty_count < capacity) {
+        trace.dirty_count++;
+    }
+}
+
+void SignalRenderer::upload_slots(Trace& trace, std::size_t first, std::size_t count) {
+    GLsizeiptr bytes = count * sizeof(float);
+    gl::BufferSubData(GL_ARRAY_BUFFER, first * sizeof(float), bytes, &trace.values[first]);
+    gl::BufferSubData(GL_ARRAY_BUFFER, (first + capacity) * sizeof(float), bytes, &trace.values[first + capacity]);
+}
+
+void SignalRenderer::render(std::size_t head, const float* max_amplitudes, bool clear) {
+    if (clear) {
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // Decimated traces are drawn from vertex 0, a min/max pair per column
+    const std::size_t vertices = decimated ? 2 * columns : capacity;
+    const std::size_t first_vertex = decimated ? 0 : head;
+
+    gl::UseProgram(program);
+    gl::Uniform1f(u_head, (float)first_vertex);
+    gl::Uniform1f(u_x_scale, 2.0f / (float)(vertices - 1));
+    gl::EnableVertexAttribArray(0);
+    if (slot_vbo) {
+        gl::BindBuffer(GL_ARRAY_BUFFER, slot_vbo);
+        gl::VertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+        gl::EnableVertexAttribArray(1);
+    }
+
+    for (std::size_t i = 0; i < traces.size(); ++i) {
+        Trace& trace = traces[i];
+        gl::BindBuffer(GL_ARRAY_BUFFER, trace.vbo);
+
+        if (decimated) {
+            // The whole window moves every frame, but it's only 2 * columns values
+            trace.pyramid.decimate(capacity, columns, trace.values);
+            gl::BufferSubData(GL_ARRAY_BUFFER, 0, vertex_floats() * sizeof(float), trace.values);
+        } else if (trace.dirty_count > 0) {
+            // Upload only the slots written since the last frame, split where the ring wraps
+            std::size_t first_run = capacity - trace.dirty_start;
+            if (trace.dirty_count <= first_run) {
+                upload_slots(trace, trace.dirty_start, trace.dirty_count);
+            } else {
+                upload_slots(trace, trace.dirty_start, first_run);
+                upload_slots(trace, 0, trace.dirty_count - first_run);
+            }
+            trace.dirty_count = 0;
+        }
+
+        float max_amplitude = max_amplitudes[i];
+        gl::Uniform1f(u_y_scale, max_amplitude == 0.0f ? 1.0f : DISPLAY_RANGE / max_amplitude);
+        gl::Uniform1f(u_y_offset, trace.style.y_offset);
+        gl::Uniform3f(u_color, trace.style.r, trace.style.g, trace.style.b);
+
+        gl::VertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glDrawArrays(GL_LINE_STRIP, (GLint)first_vertex, (GLsizei)vertices);
+    }
+
+    gl::DisableVertexAttribArray(0);
+    if (slot_vbo) {
+        gl::DisableVertexAttribArray(1);
+    }
+    gl::UseProgram(0);
+
+    // Zero lines for every trace in one fixed-function call
+    glColor3f(0.5f, 0.5f, 0.5f); // Gray
+    glEnableClientState(GL_VERTEX_ARRAY);
+    gl::BindBuffer(GL_ARRAY_BUFFER, zero_line_vbo);
+    glVertexPointer(2, GL_FLOAT, 0, nullptr);
+    glDrawArrays(GL_LINES, 0, (GLsizei)(2 * traces.size()));
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    gl::BindBuffer(GL_ARRAY_BUFFER, 0);
+    GL_CHECK("SignalRenderer::render");
+}
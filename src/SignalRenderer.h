@@ -0,0 +1,87 @@
+#ifndef SIGNAL_RENDERER_H
+#define SIGNAL_RENDERER_H
+
+#include <cstddef>
+#include <vector>
+#include "GLFunctions.h"
+#include "MinMaxPyramid.h"
+
+// Colour and vertical placement of one trace
+struct TraceStyle {
+    float r, g, b;
+    float y_offset; // Centre line of the trace in clip space
+};
+
+// Draws circular sample buffers as line strips from persistent vertex buffers.
+// Each trace's VBO holds only raw sample values, with its ring stored twice in a row
+// (slot i at vertices i and i + capacity) so the most recent `capacity` samples are
+// always one contiguous range and the whole trace is a single glDrawArrays call.
+// The vertex shader derives x from the vertex index and the ring head, and scales y
+// from per-trace uniforms, so per-frame CPU work is the upload of newly written
+// samples plus a few uniforms, independent of how many points are on screen.
+// Windows longer than two samples per pixel column are drawn from a MinMaxPyramid per trace
+// instead: each frame the window is decimated to a min/max pair per column and uploaded as
+// 2 * columns vertices, so the vertex count stays fixed however long the window is and every
+// peak still reaches the screen.
+class SignalRenderer {
+private:
+    struct Trace {
+        TraceStyle style;
+        GLuint vbo;
+        float* values; // Sample values for 2 * capacity vertices, or min/max pairs when decimating
+        std::size_t dirty_start; // First ring slot written since the last upload
+        std::size_t dirty_count; // Number of consecutive slots written since the last upload
+        MinMaxPyramid pyramid; // Every sample written, when decimating
+    };
+
+    std::size_t capacity; // Samples per trace
+    std::size_t columns; // Min/max pairs drawn per trace when decimating
+    bool decimated; // Drawing from the pyramids rather than the raw rings
+    std::vector<float> owned; // Trace storage, unless the caller supplied it
+    std::vector<Trace> traces;
+    GLuint zero_line_vbo; // One gray GL_LINES pair per trace
+
+    GLuint program;
+    GLuint slot_vbo; // Vertex indices as floats, only used when gl_VertexID is unavailable
+    GLint u_head, u_x_scale, u_y_scale, u_y_offset, u_color;
+
+    // Floats of vertex data per trace
+    std::size_t vertex_floats() const { return decimated ? 2 * columns : 2 * capacity; }
+
+    // Build the trace shader, falling back to GLSL 1.20 without gl_VertexID
+    bool build_shader();
+
+    // Upload ring slots [first, first + count) of a trace (no wraparound) into both copies
+    void upload_slots(Trace& trace, std::size_t first, std::size_t count);
+
+public:
+    // Floats of trace storage (vertex data and pyramids) a renderer of this shape needs
+    static std::size_t storage_floats(std::size_t capacity, std::size_t traces, std::size_t columns = 0);
+
+    // - columns: Horizontal resolution (pixels); a capacity above 2 * columns switches to
+    //   decimation. Leave it 0 to always draw every sample.
+    // - storage: storage_floats() floats that outlive the renderer (e.g. from an Arena), or
+    //   nullptr for the renderer to allocate its own. Uploads read straight from it.
+    SignalRenderer(std::size_t capacity, const std::vector<TraceStyle>& styles, std::size_t columns = 0,
+                   float* storage = nullptr);
+
+    bool is_decimated() const { return decimated; }
+
+    // Create the shader and GPU buffers; call once the GL context is current
+    bool init();
+
+    // Release the GPU objects; call before the context is destroyed
+    void shutdown();
+
+    // Store one sample in a trace's ring slot; it reaches the GPU on the next render().
+    // When decimating, the slot is ignored and samples are taken in the order they are written.
+    void write(std::size_t trace, std::size_t slot, float value);
+
+    // Clear and draw every trace
+    // - head: Ring slot holding the oldest sample (drawn at the left edge); unused when decimating
+    // - max_amplitudes: Per-trace scale; each trace spans +/-0.5 around its offset at this amplitude
+    // - clear: false to draw over what is already there (e.g. another renderer's traces)
+    void render(std::size_t head, const float* max_amplitudes, bool clear = true);
+};
+
+#endif // SIGNAL_RENDERER_H
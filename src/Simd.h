@@ -0,0 +1,106 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cmath>
+#include <cstddef>
+
+// Thin wrapper over the widest float vector the compiler targets.
+// The instruction set is picked at compile time from the usual predefined macros;
+// build with -mavx2 (or -march=native) to enable the AVX path on x86.
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+
+#if defined(__AVX__)
+
+typedef __m256 vfloat;
+const std::size_t WIDTH = 8;
+const char* const ISA_NAME = "AVX";
+
+inline vfloat load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+inline vfloat set1(float x) { return _mm256_set1_ps(x); }
+inline vfloat add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat max(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+inline vfloat abs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline vfloat sqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+typedef __m128 vfloat;
+const std::size_t WIDTH = 4;
+const char* const ISA_NAME = "SSE2";
+
+inline vfloat load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+inline vfloat set1(float x) { return _mm_set1_ps(x); }
+inline vfloat add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+inline vfloat mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat max(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+inline vfloat abs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline vfloat sqrt(vfloat a) { return _mm_sqrt_ps(a); }
+
+#elif defined(__ARM_NEON)
+
+typedef float32x4_t vfloat;
+const std::size_t WIDTH = 4;
+const char* const ISA_NAME = "NEON";
+
+inline vfloat load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, vfloat v) { vst1q_f32(p, v); }
+inline vfloat set1(float x) { return vdupq_n_f32(x); }
+inline vfloat add(vfloat a, vfloat b) { return vaddq_f32(a, b); }
+inline vfloat sub(vfloat a, vfloat b) { return vsubq_f32(a, b); }
+inline vfloat mul(vfloat a, vfloat b) { return vmulq_f32(a, b); }
+inline vfloat max(vfloat a, vfloat b) { return vmaxq_f32(a, b); }
+inline vfloat abs(vfloat a) { return vabsq_f32(a); }
+#if defined(__aarch64__)
+inline vfloat sqrt(vfloat a) { return vsqrtq_f32(a); }
+#else
+// ARMv7 NEON has no vector square root; go through the lanes
+inline vfloat sqrt(vfloat a) {
+    float lanes[4];
+    vst1q_f32(lanes, a);
+    for (float& lane : lanes) {
+        lane = std::sqrt(lane);
+    }
+    return vld1q_f32(lanes);
+}
+#endif
+
+#else
+
+// Scalar fallback: one lane
+typedef float vfloat;
+const std::size_t WIDTH = 1;
+const char* const ISA_NAME = "scalar";
+
+inline vfloat load(const float* p) { return *p; }
+inline void store(float* p, vfloat v) { *p = v; }
+inline vfloat set1(float x) { return x; }
+inline vfloat add(vfloat a, vfloat b) { return a + b; }
+inline vfloat sub(vfloat a, vfloat b) { return a - b; }
+inline vfloat mul(vfloat a, vfloat b) { return a * b; }
+inline vfloat max(vfloat a, vfloat b) { return a > b ? a : b; }
+inline vfloat abs(vfloat a) { return a < 0.0f ? -a : a; }
+inline vfloat sqrt(vfloat a) { return std::sqrt(a); }
+
+#endif
+
+// Round a lane count up to a whole number of vectors
+constexpr std::size_t round_up(std::size_t n) {
+    return (n + WIDTH - 1) / WIDTH * WIDTH;
+}
+
+} // namespace simd
+
+#endif // SIMD_H
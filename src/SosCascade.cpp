@@ -0,0 +1,172 @@
+#include "SosCascade.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+#define PI 3.14159265358979323846
+
+typedef std::complex<double> complex;
+
+std::size_t sos_sections(FilterType type, int order) {
+    if (order < 1) {
+        return 0;
+    }
+    return type == FilterType::BandPass ? (std::size_t)order : (std::size_t)(order + 1) / 2;
+}
+
+// Poles of the analog low-pass prototype (cutoff 1 rad/s). ripple_db <= 0 selects Butterworth.
+static std::vector<complex> prototype_poles(int order, double ripple_db) {
+    std::vector<complex> poles;
+    if (ripple_db <= 0.0) {
+        for (int k = 0; k < order; ++k) {
+            double theta = PI * (2.0 * k + order + 1) / (2.0 * order);
+            poles.push_back(std::polar(1.0, theta));
+        }
+        return poles;
+    }
+
+    double epsilon = std::sqrt(std::pow(10.0, ripple_db / 10.0) - 1.0);
+    double mu = std::asinh(1.0 / epsilon) / order;
+    for (int k = 0; k < order; ++k) {
+        double theta = PI * (2.0 * k + 1) / (2.0 * order);
+        poles.push_back(complex(-std::sinh(mu) * std::sin(theta), std::cosh(mu) * std::cos(theta)));
+    }
+    return poles;
+}
+
+// Response of the cascade at normalized angular frequency omega (radians/sample)
+static double magnitude(const std::vector<BiquadCoefficients>& sections, double omega) {
+    complex z1 = std::polar(1.0, -omega);
+    complex z2 = z1 * z1;
+    complex response = 1.0;
+    for (const BiquadCoefficients& c : sections) {
+        response *= ((double)c.b0 + (double)c.b1 * z1 + (double)c.b2 * z2) / (1.0 + (double)c.a1 * z1 + (double)c.a2 * z2);
+    }
+    return std::abs(response);
+}
+
+// Shared design path: prototype -> analog frequency transform -> bilinear transform -> sections.
+// All digital zeros of these responses sit at z = +1 and/or z = -1, so each section's numerator
+// follows from the filter type and only the poles need pairing.
+static std::vector<BiquadCoefficients> design_sections(FilterType type, int order, double ripple_db, float sample_rate,
+                                                        float freq1, float freq2) {
+    std::vector<BiquadCoefficients> sections;
+    if (order < 1 || !(sample_rate > 0.0f) || !(freq1 > 0.0f) || (type == FilterType::BandPass && !(freq2 > freq1))) {
+        return sections;
+    }
+
+    // Pre-warp the edges so they land exactly on the requested digital frequencies
+    const double fs2 = 2.0 * sample_rate;
+    const double warped1 = fs2 * std::tan(PI * freq1 / sample_rate);
+    const double warped2 = type == FilterType::BandPass ? fs2 * std::tan(PI * freq2 / sample_rate) : 0.0;
+
+    std::vector<complex> analog;
+    for (const complex& p : prototype_poles(order, ripple_db)) {
+        switch (type) {
+            case FilterType::LowPass:
+                analog.push_back(p * warped1);
+                break;
+            case FilterType::HighPass:
+                analog.push_back(warped1 / p);
+                break;
+            case FilterType::BandPass: {
+                double bandwidth = warped2 - warped1;
+                double center_squared = warped1 * warped2;
+                complex half = p * bandwidth / 2.0;
+                complex root = std::sqrt(half * half - center_squared);
+                analog.push_back(half + root);
+                analog.push_back(half - root);
+                break;
+            }
+        }
+    }
+
+    // Bilinear transform, keeping one pole of each conjugate pair plus the real poles
+    std::vector<complex> upper;
+    std::vector<double> real;
+    for (const complex& s : analog) {
+        complex z = (fs2 + s) / (fs2 - s);
+        if (std::abs(z.imag()) < 1e-9) {
+            real.push_back(z.real());
+        } else if (z.imag() > 0.0) {
+            upper.push_back(z);
+        }
+    }
+
+    // Numerator of a full section: (1 + z^-1)^2, (1 - z^-1)^2 or (1 - z^-2)
+    float b1 = type == FilterType::LowPass ? 2.0f : (type == FilterType::HighPass ? -2.0f : 0.0f);
+    float b2 = type == FilterType::BandPass ? -1.0f : 1.0f;
+
+    std::vector<std::pair<double, BiquadCoefficients>> ranked; // Pole radius, section
+    for (const complex& z : upper) {
+        BiquadCoefficients c = { 1.0f, b1, b2, (float)(-2.0 * z.real()), (float)std::norm(z) };
+        ranked.push_back(std::make_pair(std::abs(z), c));
+    }
+    std::sort(real.begin(), real.end());
+    for (std::size_t i = 0; i + 1 < real.size(); i += 2) {
+        BiquadCoefficients c = { 1.0f, b1, b2, (float)-(real[i] + real[i + 1]), (float)(real[i] * real[i + 1]) };
+        ranked.push_back(std::make_pair(std::max(std::abs(real[i]), std::abs(real[i + 1])), c));
+    }
+    if (real.size() % 2 != 0) {
+        // Odd low/high-pass order: one first-order section, zero at -1 or +1
+        float first_order_b1 = type == FilterType::HighPass ? -1.0f : 1.0f;
+        BiquadCoefficients c = { 1.0f, first_order_b1, 0.0f, (float)-real.back(), 0.0f };
+        ranked.push_back(std::make_pair(std::abs(real.back()), c));
+    }
+
+    // Least resonant sections first, so the high-Q ones see an already band-limited signal
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const std::pair<double, BiquadCoefficients>& a, const std::pair<double, BiquadCoefficients>& b) {
+                         return a.first < b.first;
+                     });
+    for (const auto& entry : ranked) {
+        sections.push_back(entry.second);
+    }
+
+    // Normalize the gain at the passband reference (DC, Nyquist, or the geometric band centre).
+    // Even-order Chebyshev filters sit at the bottom of the ripple there rather than at unity.
+    double reference = 0.0;
+    if (type == FilterType::HighPass) {
+        reference = PI;
+    } else if (type == FilterType::BandPass) {
+        reference = 2.0 * std::atan(std::sqrt(warped1 * warped2) / fs2);
+    }
+    double target = 1.0;
+    if (ripple_db > 0.0 && order % 2 == 0) {
+        target = 1.0 / std::sqrt(std::pow(10.0, ripple_db / 10.0));
+    }
+    double gain = target / magnitude(sections, reference);
+
+    // Spread the gain evenly so no intermediate section overflows or loses precision
+    float per_section = (float)std::pow(gain, 1.0 / sections.size());
+    for (BiquadCoefficients& c : sections) {
+        c.b0 *= per_section;
+        c.b1 *= per_section;
+        c.b2 *= per_section;
+    }
+    return sections;
+}
+
+std::vector<BiquadCoefficients> design_butterworth(FilterType type, int order, float sample_rate, float freq1, float freq2) {
+    return design_sections(type, order, 0.0, sample_rate, freq1, freq2);
+}
+
+std::vector<BiquadCoefficients> design_chebyshev1(FilterType type, int order, float ripple_db, float sample_rate,
+                                                  float freq1, float freq2) {
+    return design_sections(type, order, ripple_db > 0.0f ? ripple_db : 0.0, sample_rate, freq1, freq2);
+}
+
+BiquadCoefficients design_notch(float sample_rate, float freq, float q) {
+    double omega = 2.0 * PI * freq / sample_rate;
+    double alpha = std::sin(omega) / (2.0 * q);
+    double cosw = std::cos(omega);
+    double a0 = 1.0 + alpha;
+
+    BiquadCoefficients c;
+    c.b0 = (float)(1.0 / a0);
+    c.b1 = (float)(-2.0 * cosw / a0);
+    c.b2 = (float)(1.0 / a0);
+    c.a1 = (float)(-2.0 * cosw / a0);
+    c.a2 = (float)((1.0 - alpha) / a0);
+    return c;
+}
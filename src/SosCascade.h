@@ -0,0 +1,125 @@
+#ifndef SOS_CASCADE_H
+#define SOS_CASCADE_H
+
+#include <cstddef>
+#include <vector>
+#include "Filter.h"
+
+// Higher-order IIR filter as a cascade of second-order sections (biquads)
+// - Stages: Number of sections, fixed at compile time so the per-sample loop over
+//   sections unrolls completely and every delay line stays in a register
+// Sections run in Direct Form I. Adjacent sections share their delay lines (a section's
+// output history is the next section's input history), so the cascade holds Stages + 1
+// pairs of state. The previous output is folded in last, so the loop-carried dependency is
+// one multiply and one subtract; results match chained Filter objects to float rounding.
+template <std::size_t Stages>
+class SosCascade {
+    static_assert(Stages >= 1, "SosCascade needs at least one section");
+
+private:
+    BiquadCoefficients sections[Stages];
+    float z1[Stages + 1]; // Most recent value at each node (node k feeds section k)
+    float z2[Stages + 1]; // Value before that
+
+public:
+    // Passes the signal through unchanged until sections are set
+    SosCascade() {
+        BiquadCoefficients identity = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for (std::size_t k = 0; k < Stages; ++k) {
+            sections[k] = identity;
+        }
+        reset();
+    }
+
+    // Load a design; a shorter list leaves the remaining sections as pass-through
+    explicit SosCascade(const std::vector<BiquadCoefficients>& design) : SosCascade() {
+        set_sections(design);
+    }
+
+    // Replace the coefficients without touching the delay lines; extra sections are ignored
+    void set_sections(const std::vector<BiquadCoefficients>& design) {
+        for (std::size_t k = 0; k < Stages && k < design.size(); ++k) {
+            sections[k] = design[k];
+        }
+    }
+    void set_section(std::size_t stage, const BiquadCoefficients& c) { sections[stage] = c; }
+    const BiquadCoefficients& section(std::size_t stage) const { return sections[stage]; }
+
+    // Zero every delay line
+    void reset() {
+        for (std::size_t k = 0; k <= Stages; ++k) {
+            z1[k] = z2[k] = 0.0f;
+        }
+    }
+
+    static constexpr std::size_t stages() { return Stages; }
+
+    // Process a single input sample and return the output
+    float process(float input) {
+        float value = input;
+        for (std::size_t k = 0; k < Stages; ++k) {
+            const BiquadCoefficients& c = sections[k];
+            float output = (c.b0 * value + c.b1 * z1[k] + c.b2 * z2[k] - c.a2 * z2[k + 1]) - c.a1 * z1[k + 1];
+            z2[k] = z1[k];
+            z1[k] = value;
+            value = output;
+        }
+        z2[Stages] = z1[Stages];
+        z1[Stages] = value;
+        return value;
+    }
+
+    // Process a block of n samples from in to out (in and out may be the same buffer).
+    // Coefficients and delay lines are copied into locals for the whole block; with the
+    // section loop unrolled they stay in registers and each sample makes one pass.
+    void process(const float* in, float* out, std::size_t n) {
+        BiquadCoefficients c[Stages];
+        float s1[Stages + 1], s2[Stages + 1];
+        for (std::size_t k = 0; k < Stages; ++k) {
+            c[k] = sections[k];
+        }
+        for (std::size_t k = 0; k <= Stages; ++k) {
+            s1[k] = z1[k];
+            s2[k] = z2[k];
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            float value = in[i];
+            for (std::size_t k = 0; k < Stages; ++k) {
+                float output = (c[k].b0 * value + c[k].b1 * s1[k] + c[k].b2 * s2[k] - c[k].a2 * s2[k + 1]) - c[k].a1 * s1[k + 1];
+                s2[k] = s1[k];
+                s1[k] = value;
+                value = output;
+            }
+            s2[Stages] = s1[Stages];
+            s1[Stages] = value;
+            out[i] = value;
+        }
+
+        for (std::size_t k = 0; k <= Stages; ++k) {
+            z1[k] = s1[k];
+            z2[k] = s2[k];
+        }
+    }
+
+    // Process a block of n samples in place
+    void process(float* samples, std::size_t n) { process(samples, samples, n); }
+};
+
+// Number of second-order sections an order-N design of this type produces.
+// For band-pass, order is the prototype order; the filter has 2 * order poles.
+std::size_t sos_sections(FilterType type, int order);
+
+// Butterworth design (maximally flat passband), normalized to unity passband gain.
+// freq1 is the cutoff for low/high-pass; freq1..freq2 are the -3 dB band edges for band-pass.
+std::vector<BiquadCoefficients> design_butterworth(FilterType type, int order, float sample_rate, float freq1, float freq2 = 0.0f);
+
+// Chebyshev type I design with ripple_db of passband ripple; steeper than Butterworth of the
+// same order. Cutoffs are the passband edges (where the response leaves the ripple band).
+std::vector<BiquadCoefficients> design_chebyshev1(FilterType type, int order, float ripple_db, float sample_rate,
+                                                  float freq1, float freq2 = 0.0f);
+
+// Second-order notch at freq (e.g. 50 or 60 Hz mains); q sets the width (-3 dB bandwidth = freq / q)
+BiquadCoefficients design_notch(float sample_rate, float freq, float q = 30.0f);
+
+#endif // SOS_CASCADE_H
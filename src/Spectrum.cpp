@@ -0,0 +1,192 @@
+#include "Spectrum.h"
+#include <algorithm>
+#include <cmath>
+
+#define PI 3.14159265358979323846
+
+FftPlan::FftPlan(std::size_t size) : length(size) {
+    const std::size_t half = size / 2;
+
+    std::size_t bits = 0;
+    while (((std::size_t)1 << bits) < half) {
+        ++bits;
+    }
+    reverse.resize(half);
+    for (std::size_t i = 0; i < half; ++i) {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        reverse[i] = (std::uint32_t)r;
+    }
+
+    // Tables are computed in double so every entry is correctly rounded
+    for (std::size_t k = 0; k < half / 2; ++k) {
+        twiddle_re.push_back((float)std::cos(-2.0 * PI * k / half));
+        twiddle_im.push_back((float)std::sin(-2.0 * PI * k / half));
+    }
+    for (std::size_t k = 0; k <= half / 2; ++k) {
+        split_re.push_back((float)std::cos(-2.0 * PI * k / size));
+        split_im.push_back((float)std::sin(-2.0 * PI * k / size));
+    }
+}
+
+void FftPlan::forward(const float* in, float* re, float* im) const {
+    const std::size_t half = length / 2;
+
+    // Pack even samples as real parts and odd samples as imaginary parts, in bit-reversed order
+    for (std::size_t i = 0; i < half; ++i) {
+        re[reverse[i]] = in[2 * i];
+        im[reverse[i]] = in[2 * i + 1];
+    }
+
+    // Iterative radix-2 butterflies over the half-size complex transform
+    for (std::size_t span = 1; span < half; span *= 2) {
+        const std::size_t stride = half / (2 * span); // Twiddle table step at this stage
+        for (std::size_t start = 0; start < half; start += 2 * span) {
+            for (std::size_t j = 0; j < span; ++j) {
+                const float wr = twiddle_re[j * stride], wi = twiddle_im[j * stride];
+                const std::size_t a = start + j, b = a + span;
+                const float vr = re[b] * wr - im[b] * wi;
+                const float vi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - vr;
+                im[b] = im[a] - vi;
+                re[a] += vr;
+                im[a] += vi;
+            }
+        }
+    }
+
+    // Split into the spectrum of the real input. With A = Z[k] and B = conj(Z[half - k]),
+    // E = (A + B) / 2 and O = (A - B) / 2i are the even/odd sample spectra, and
+    // X[k] = E + W^k O while X[half - k] = conj(E - W^k O), with W = exp(-2 pi i / n).
+    const float dc_re = re[0], dc_im = im[0];
+    re[0] = dc_re + dc_im;
+    im[0] = 0.0f;
+    re[half] = dc_re - dc_im;
+    im[half] = 0.0f;
+    for (std::size_t k = 1; k <= half / 2; ++k) {
+        const std::size_t m = half - k;
+        const float ar = re[k], ai = im[k];
+        const float br = re[m], bi = -im[m];
+
+        const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        const float or_ = 0.5f * (ai - bi), oi = -0.5f * (ar - br);
+        const float wr = split_re[k], wi = split_im[k];
+        const float tr = wr * or_ - wi * oi;
+        const float ti = wr * oi + wi * or_;
+
+        re[k] = er + tr;
+        im[k] = ei + ti;
+        if (m != k) {
+            re[m] = er - tr;
+            im[m] = -(ei - ti);
+        }
+    }
+}
+
+SpectralAnalyzer::SpectralAnalyzer(std::size_t channels, float sample_rate, std::size_t window, std::size_t hop)
+    : count(channels), length(window), step(std::min(std::max<std::size_t>(hop, 1), window)), sample_rate(sample_rate),
+      plan(window), taper(window), densities(channels * plan.bins()),
+      results(channels), frame(window), re(plan.bins()), im(plan.bins()) {
+    // Periodic Hann window, and the scale that turns |X|^2 into a one-sided density
+    double energy = 0.0;
+    for (std::size_t i = 0; i < window; ++i) {
+        double w = 0.5 - 0.5 * std::cos(2.0 * PI * i / window);
+        taper[i] = (float)w;
+        energy += w * w;
+    }
+    psd_scale = (float)(2.0 / (sample_rate * energy));
+    history.reserve(channels);
+    for (std::size_t ch = 0; ch < channels; ++ch) {
+        history.emplace_back(window);
+    }
+    reset();
+}
+
+void SpectralAnalyzer::reset() {
+    for (MirroredRing<float>& ring : history) {
+        ring.reset();
+    }
+    std::fill(densities.begin(), densities.end(), 0.0f);
+    std::fill(results.begin(), results.end(), SpectralResult());
+    filled = 0;
+    until_next = length;
+    completed = 0;
+}
+
+void SpectralAnalyzer::analyze(std::size_t channel) {
+    // The window, oldest first, straight from the ring
+    const float* window = history[channel].latest(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        frame[i] = window[i] * taper[i];
+    }
+
+    plan.forward(frame.data(), re.data(), im.data());
+
+    // One-sided PSD: interior bins carry the power of their negative-frequency twins
+    const std::size_t bins = plan.bins();
+    float* density = densities.data() + channel * bins;
+    for (std::size_t k = 0; k < bins; ++k) {
+        float scale = (k == 0 || k == bins - 1) ? 0.5f * psd_scale : psd_scale;
+        density[k] = (re[k] * re[k] + im[k] * im[k]) * scale;
+    }
+
+    // Mean and median over bins 1..Nyquist, accumulated in double
+    const double df = resolution();
+    double power = 0.0, moment = 0.0;
+    for (std::size_t k = 1; k < bins; ++k) {
+        power += density[k];
+        moment += density[k] * (double)k;
+    }
+    SpectralResult& result = results[channel];
+    result.total_power = (float)(power * df);
+    if (!(power > 0.0)) {
+        result.mean_frequency = result.median_frequency = 0.0f;
+        return;
+    }
+    result.mean_frequency = (float)(moment / power * df);
+
+    // Each bin covers k +- 1/2; interpolate within the bin where the cumulative power crosses half
+    double half = 0.5 * power, cumulative = 0.0;
+    for (std::size_t k = 1; k < bins; ++k) {
+        if (cumulative + density[k] >= half) {
+            double fraction = density[k] > 0.0f ? (half - cumulative) / density[k] : 0.0;
+            result.median_frequency = (float)((k - 0.5 + fraction) * df);
+            break;
+        }
+        cumulative += density[k];
+    }
+}
+
+std::size_t SpectralAnalyzer::process(const float* in, std::size_t frames, std::size_t stride) {
+    std::size_t produced = 0;
+    std::size_t done = 0;
+    while (done < frames) {
+        // Copy up to the next spectrum boundary in one pass per channel
+        std::size_t n = std::min(frames - done, until_next);
+        for (std::size_t ch = 0; ch < count; ++ch) {
+            float* ring = history[ch].prepare();
+            const float* src = in + done * stride + ch;
+            for (std::size_t i = 0; i < n; ++i) {
+                ring[i] = src[i * stride];
+            }
+            history[ch].commit(n);
+        }
+        done += n;
+        filled = std::min(filled + n, length);
+        until_next -= n;
+
+        if (until_next == 0) {
+            until_next = step;
+            if (filled == length) {
+                for (std::size_t ch = 0; ch < count; ++ch) {
+                    analyze(ch);
+                }
+                ++completed;
+                ++produced;
+            }
+        }
+    }
+    return produced;
+}
@@ -0,0 +1,91 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MirroredRing.h"
+
+// Precomputed plan for a forward real FFT of a fixed power-of-two size.
+// The transform runs as a complex FFT of half the size on the even/odd samples packed into
+// real/imaginary parts, followed by a split step; the bit-reversal permutation and both
+// twiddle tables are built once in the constructor, so forward() neither allocates nor
+// calls any trig function.
+class FftPlan {
+private:
+    std::size_t length; // Real input length n
+    std::vector<std::uint32_t> reverse; // Bit-reversal permutation of the n / 2 point transform
+    std::vector<float> twiddle_re, twiddle_im; // exp(-2 pi i k / (n / 2)), k < n / 4
+    std::vector<float> split_re, split_im; // exp(-2 pi i k / n), k <= n / 4
+
+public:
+    // size must be a power of two, at least 4
+    explicit FftPlan(std::size_t size);
+
+    std::size_t size() const { return length; }
+    std::size_t bins() const { return length / 2 + 1; }
+
+    // Transform n real samples into bins() complex bins (DC through Nyquist).
+    // re and im need bins() floats each; they double as the working storage.
+    void forward(const float* in, float* re, float* im) const;
+};
+
+// Spectral summary of one window
+struct SpectralResult {
+    float mean_frequency = 0.0f; // Power-weighted mean frequency (Hz)
+    float median_frequency = 0.0f; // Frequency splitting the power in half (Hz)
+    float total_power = 0.0f; // Signal power in the analyzed bins
+};
+
+// Streaming spectral analysis: every `hop` frames, each channel's last `window` samples are
+// Hann-windowed and transformed, giving a one-sided power spectral density (units^2 / Hz) and
+// its mean and median frequency. Inputs are interleaved [frame][channel] like FilterBank; the
+// plan, window and scratch are shared by all channels and allocated once. The DC bin is left
+// out of the frequency statistics so a residual offset can't pull them down.
+class SpectralAnalyzer {
+private:
+    std::size_t count; // Channels
+    std::size_t length; // Window length in frames
+    std::size_t step; // Frames between spectra
+    float sample_rate;
+    FftPlan plan;
+    std::vector<float> taper; // Hann window
+    float psd_scale; // |X|^2 to one-sided PSD for an interior bin
+
+    std::vector<MirroredRing<float>> history; // Recent samples per channel; each window is one span
+    std::size_t filled; // Frames in the ring, up to length
+    std::size_t until_next; // Frames left before the next spectrum
+    std::uint64_t completed; // Spectra computed so far (per channel)
+
+    std::vector<float> densities; // [channel][bins] latest PSD
+    std::vector<SpectralResult> results;
+    std::vector<float> frame, re, im; // Scratch for one transform
+
+    void analyze(std::size_t channel);
+
+public:
+    // window must be a power of two (at least 4); hop is clamped to 1..window
+    SpectralAnalyzer(std::size_t channels, float sample_rate, std::size_t window = 1024, std::size_t hop = 512);
+
+    // Forget all history; the next spectrum comes once a full window has arrived
+    void reset();
+
+    // Feed frames in; returns the number of new spectra produced for every channel
+    std::size_t process(const float* in, std::size_t frames) { return process(in, frames, count); }
+
+    // Feed this analyzer's channels from wider frames of stride samples each
+    std::size_t process(const float* in, std::size_t frames, std::size_t stride);
+
+    std::size_t channels() const { return count; }
+    std::size_t window() const { return length; }
+    std::size_t hop() const { return step; }
+    std::size_t bins() const { return plan.bins(); }
+    float resolution() const { return sample_rate / length; } // Hz per bin
+    std::uint64_t spectra() const { return completed; }
+
+    // Latest results for a channel (zero until the first spectrum)
+    const SpectralResult& result(std::size_t channel) const { return results[channel]; }
+    const float* psd(std::size_t channel) const { return densities.data() + channel * plan.bins(); }
+};
+
+#endif // SPECTRUM_H
@@ -0,0 +1,67 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+// Lock-free single-producer/single-consumer ring buffer
+// - T: Element type (trivially copyable)
+// - Capacity: Number of slots, must be a power of two
+// One thread may call try_push, one other thread may call try_pop/pop_bulk.
+// Neither side ever blocks; a full ring rejects the push instead of waiting.
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    // Producer and consumer indices live on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<std::size_t> head{0}; // Next slot to write (owned by producer)
+    alignas(64) std::atomic<std::size_t> tail{0}; // Next slot to read (owned by consumer)
+    alignas(64) T slots[Capacity];
+
+public:
+    // Push one element; returns false if the ring is full
+    bool try_push(const T& value) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        slots[h & MASK] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pop one element; returns false if the ring is empty
+    bool try_pop(T& value) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pop up to max_count elements into out; returns the number popped
+    std::size_t pop_bulk(T* out, std::size_t max_count) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t available = head.load(std::memory_order_acquire) - t;
+        std::size_t count = available < max_count ? available : max_count;
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = slots[(t + i) & MASK];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Approximate number of queued elements (exact when called from either owner thread)
+    std::size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,192 @@
+#include "ThreadPool.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+const unsigned IDLE_SPIN_ROUNDS = 256; // Yields before an idle worker sleeps; keeps back-to-back batches cheap
+
+// Restrict the calling thread to one core (no-op where affinity isn't supported)
+static void pin_to_core(std::size_t core) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((int)(core % CPU_SETSIZE), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)core;
+#endif
+}
+
+ThreadPool::ThreadPool(std::size_t worker_count, bool pin) {
+    std::size_t cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = 1;
+    }
+    if (worker_count == 0) {
+        worker_count = cores;
+    }
+    // Pinning more workers than cores would stack several on one core
+    pin = pin && worker_count <= cores;
+
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        queues.emplace_back(new Queue());
+    }
+    for (std::size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this, i, pin);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(wake_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+bool ThreadPool::pop_own(std::size_t worker, Task& task) {
+    Queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.tasks.size() == queue.front) {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    if (queue.tasks.size() == queue.front) {
+        queue.tasks.clear();
+        queue.front = 0;
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+// Take the oldest stealable task from another queue, starting with the thief's neighbour
+bool ThreadPool::steal(std::size_t thief, Task& task) {
+    const std::size_t count = queues.size();
+    for (std::size_t offset = 1; offset <= count; ++offset) {
+        std::size_t victim = (thief + offset) % count;
+        if (victim == thief) {
+            continue;
+        }
+        Queue& queue = *queues[victim];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.tasks.size() == queue.front || queue.tasks[queue.front].batch->pinned) {
+            continue;
+        }
+        task = queue.tasks[queue.front++];
+        if (queue.tasks.size() == queue.front) {
+            queue.tasks.clear();
+            queue.front = 0;
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::find_task(std::size_t worker, Task& task) {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    return pop_own(worker, task) || steal(worker, task);
+}
+
+void ThreadPool::run(const Task& task) {
+    task.batch->function(task.batch->context, task.index);
+    task.batch->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void ThreadPool::worker_loop(std::size_t worker, bool pin) {
+    if (pin) {
+        pin_to_core(worker);
+    }
+
+    unsigned idle = 0;
+    Task task;
+    for (;;) {
+        if (find_task(worker, task)) {
+            run(task);
+            idle = 0;
+            continue;
+        }
+        if (stopping.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (++idle < IDLE_SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(wake_lock);
+        wake.wait(guard, [this] { return stopping.load() || queued.load() > 0; });
+        idle = 0;
+    }
+}
+
+void ThreadPool::submit(Batch& batch, std::size_t count, const std::size_t* home) {
+    const std::size_t worker_count = queues.size();
+    // Queue in reverse so each owner's back-of-queue pops run its range in ascending order
+    for (std::size_t i = count; i-- > 0;) {
+        std::size_t owner = home ? home[i] % worker_count : i * worker_count / count;
+        Queue& queue = *queues[owner];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        Task task = { &batch, i };
+        queue.tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> guard(wake_lock);
+        queued.fetch_add(count, std::memory_order_release);
+    }
+    wake.notify_all();
+}
+
+void ThreadPool::run_batch(std::size_t count, TaskFunction function, void* context, const std::size_t* home) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> guard(submit_lock);
+    Batch batch;
+    batch.function = function;
+    batch.context = context;
+    batch.pinned = false;
+    batch.remaining = count;
+    submit(batch, count, home);
+
+    // Help instead of idling; the caller isn't a worker, so it only ever steals
+    Task task;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (steal(queues.size(), task)) {
+            run(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::run_on_each_worker(TaskFunction function, void* context) {
+    std::lock_guard<std::mutex> guard(submit_lock);
+    std::vector<std::size_t> home(queues.size());
+    for (std::size_t i = 0; i < home.size(); ++i) {
+        home[i] = i;
+    }
+    Batch batch;
+    batch.function = function;
+    batch.context = context;
+    batch.pinned = true;
+    batch.remaining = home.size();
+    submit(batch, home.size(), home.data());
+
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
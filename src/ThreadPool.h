@@ -0,0 +1,93 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads with one task queue each. A batch of tasks is spread over
+// the queues by "home" worker; a worker runs its own tasks first (newest first, while the
+// data it just touched is still in cache) and steals the oldest tasks from other queues
+// once its own is empty. Workers can be pinned one per core.
+class ThreadPool {
+public:
+    typedef void (*TaskFunction)(void* context, std::size_t index);
+
+private:
+    struct Batch {
+        TaskFunction function;
+        void* context;
+        bool pinned; // Tasks must run on their home worker and are never stolen
+        std::atomic<std::size_t> remaining;
+    };
+
+    struct Task {
+        Batch* batch;
+        std::size_t index;
+    };
+
+    // One per worker, on its own cache lines
+    struct alignas(64) Queue {
+        std::mutex lock;
+        std::vector<Task> tasks; // Owner pops from the back, thieves take from the front
+        std::size_t front = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    std::atomic<std::size_t> queued{0}; // Tasks not yet taken from any queue
+    std::atomic<bool> stopping{false};
+    std::mutex submit_lock; // One batch at a time
+
+    void submit(Batch& batch, std::size_t count, const std::size_t* home);
+    bool pop_own(std::size_t worker, Task& task);
+    bool steal(std::size_t thief, Task& task);
+    bool find_task(std::size_t worker, Task& task);
+    void run(const Task& task);
+    void worker_loop(std::size_t worker, bool pin);
+
+public:
+    // workers = 0 uses one per hardware thread; pin ties worker i to core i
+    explicit ThreadPool(std::size_t workers = 0, bool pin = true);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    // Run function(context, i) for every i in [0, count) and wait for all of them.
+    // Task i is queued on worker home[i] (or i * size() / count, spreading contiguous
+    // ranges, if home is null). The calling thread helps by stealing while it waits.
+    void run_batch(std::size_t count, TaskFunction function, void* context, const std::size_t* home = nullptr);
+
+    // Run function(context, w) once on each worker w, without stealing, and wait.
+    // Used for per-worker setup such as allocating state from the thread that will use it.
+    void run_on_each_worker(TaskFunction function, void* context);
+
+    // run_batch for a callable taking the task index
+    template <typename F>
+    void parallel_for(std::size_t count, F&& body, const std::size_t* home = nullptr) {
+        typedef typename std::remove_reference<F>::type Body;
+        run_batch(count, [](void* context, std::size_t index) { (*static_cast<Body*>(context))(index); },
+                  const_cast<void*>(static_cast<const void*>(&body)), home);
+    }
+
+    // run_on_each_worker for a callable taking the worker index
+    template <typename F>
+    void for_each_worker(F&& body) {
+        typedef typename std::remove_reference<F>::type Body;
+        run_on_each_worker([](void* context, std::size_t worker) { (*static_cast<Body*>(context))(worker); },
+                           const_cast<void*>(static_cast<const void*>(&body)));
+    }
+};
+
+#endif // THREAD_POOL_H